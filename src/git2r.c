@@ -27,6 +27,7 @@
 #include "git2r_arg.h"
 #include "git2r_blame.h"
 #include "git2r_blob.h"
+#include "git2r_bloom.h"
 #include "git2r_branch.h"
 #include "git2r_checkout.h"
 #include "git2r_clone.h"
@@ -37,10 +38,12 @@
 #include "git2r_graph.h"
 #include "git2r_index.h"
 #include "git2r_libgit2.h"
+#include "git2r_log.h"
 #include "git2r_merge.h"
 #include "git2r_note.h"
 #include "git2r_object.h"
 #include "git2r_odb.h"
+#include "git2r_oid.h"
 #include "git2r_push.h"
 #include "git2r_reference.h"
 #include "git2r_reflog.h"
@@ -61,12 +64,20 @@
 
 static const R_CallMethodDef callMethods[] =
 {
-    CALLDEF(git2r_blame_file, 2),
-    CALLDEF(git2r_blob_content, 2),
+    CALLDEF(git2r_blame_buffer, 5),
+    CALLDEF(git2r_blame_cache_clear, 1),
+    CALLDEF(git2r_blame_file, 8),
+    CALLDEF(git2r_blame_files, 6),
+    CALLDEF(git2r_blob_content, 3),
     CALLDEF(git2r_blob_create_fromdisk, 2),
     CALLDEF(git2r_blob_create_fromworkdir, 2),
     CALLDEF(git2r_blob_is_binary, 1),
     CALLDEF(git2r_blob_rawsize, 1),
+    CALLDEF(git2r_blob_reader_close, 1),
+    CALLDEF(git2r_blob_reader_lines, 2),
+    CALLDEF(git2r_blob_reader_open, 1),
+    CALLDEF(git2r_blob_reader_read, 3),
+    CALLDEF(git2r_bloom_index_update, 1),
     CALLDEF(git2r_branch_canonical_name, 1),
     CALLDEF(git2r_branch_create, 3),
     CALLDEF(git2r_branch_delete, 1),
@@ -90,13 +101,16 @@ static const R_CallMethodDef callMethods[] =
     CALLDEF(git2r_config_get_logical, 2),
     CALLDEF(git2r_config_get_string, 2),
     CALLDEF(git2r_config_set, 2),
-    CALLDEF(git2r_diff, 12),
+    CALLDEF(git2r_diff, 13),
     CALLDEF(git2r_graph_ahead_behind, 2),
+    CALLDEF(git2r_graph_ahead_behind_table, 3),
     CALLDEF(git2r_graph_descendant_of, 2),
     CALLDEF(git2r_index_add_all, 3),
     CALLDEF(git2r_index_remove_bypath, 2),
     CALLDEF(git2r_libgit2_features, 0),
     CALLDEF(git2r_libgit2_version, 0),
+    CALLDEF(git2r_log_churn, 6),
+    CALLDEF(git2r_log_stats, 6),
     CALLDEF(git2r_merge_base, 2),
     CALLDEF(git2r_merge_branch, 4),
     CALLDEF(git2r_merge_fetch_heads, 2),
@@ -107,8 +121,16 @@ static const R_CallMethodDef callMethods[] =
     CALLDEF(git2r_object_lookup, 2),
     CALLDEF(git2r_odb_blobs, 1),
     CALLDEF(git2r_odb_hash, 1),
-    CALLDEF(git2r_odb_hashfile, 1),
-    CALLDEF(git2r_odb_objects, 1),
+    CALLDEF(git2r_odb_hash_final, 1),
+    CALLDEF(git2r_odb_hash_init, 1),
+    CALLDEF(git2r_odb_hash_raw, 1),
+    CALLDEF(git2r_odb_hash_update, 2),
+    CALLDEF(git2r_odb_hashfile, 2),
+    CALLDEF(git2r_odb_objects, 4),
+    CALLDEF(git2r_oid_vector_duplicated, 1),
+    CALLDEF(git2r_oid_vector_format, 1),
+    CALLDEF(git2r_oid_vector_match, 2),
+    CALLDEF(git2r_oid_vector_parse, 1),
     CALLDEF(git2r_push, 5),
     CALLDEF(git2r_reference_dwim, 2),
     CALLDEF(git2r_reference_list, 1),
@@ -121,6 +143,9 @@ static const R_CallMethodDef callMethods[] =
     CALLDEF(git2r_remote_set_url, 3),
     CALLDEF(git2r_remote_url, 2),
     CALLDEF(git2r_remote_ls, 4),
+    CALLDEF(git2r_repository_cache_clear, 1),
+    CALLDEF(git2r_repository_cache_size, 1),
+    CALLDEF(git2r_repository_cache_stats, 0),
     CALLDEF(git2r_repository_can_open, 1),
     CALLDEF(git2r_repository_discover, 2),
     CALLDEF(git2r_repository_fetch_heads, 1),
@@ -139,6 +164,7 @@ static const R_CallMethodDef callMethods[] =
     CALLDEF(git2r_revwalk_contributions, 4),
     CALLDEF(git2r_revwalk_list, 6),
     CALLDEF(git2r_revwalk_list2, 7),
+    CALLDEF(git2r_revwalk_table, 7),
     CALLDEF(git2r_signature_default, 1),
     CALLDEF(git2r_ssl_cert_locations, 2),
     CALLDEF(git2r_stash_apply, 2),
@@ -146,11 +172,13 @@ static const R_CallMethodDef callMethods[] =
     CALLDEF(git2r_stash_list, 1),
     CALLDEF(git2r_stash_pop, 2),
     CALLDEF(git2r_stash_save, 6),
-    CALLDEF(git2r_status_list, 6),
+    CALLDEF(git2r_status_cache_clear, 1),
+    CALLDEF(git2r_status_list, 9),
+    CALLDEF(git2r_status_table, 5),
     CALLDEF(git2r_tag_create, 5),
     CALLDEF(git2r_tag_delete, 2),
     CALLDEF(git2r_tag_list, 1),
-    CALLDEF(git2r_tree_walk, 2),
+    CALLDEF(git2r_tree_walk, 6),
     {NULL, NULL, 0}
 };
 
@@ -180,5 +208,8 @@ void
 R_unload_git2r(DllInfo *info)
 {
     GIT2R_UNUSED(info);
+    git2r_repository_cache_free();
+    git2r_status_cache_free();
+    git2r_blame_cache_free();
     git_libgit2_shutdown();
 }
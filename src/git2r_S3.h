@@ -125,6 +125,8 @@ enum {
     git2r_S3_item__git_note__refname,
     git2r_S3_item__git_note__repo};
 
+extern const char *git2r_S3_class__git_oid_vector;
+
 extern const char *git2r_S3_class__git_reference;
 extern const char *git2r_S3_items__git_reference[];
 enum {
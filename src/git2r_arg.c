@@ -258,7 +258,8 @@ git2r_arg_check_filename(
 /**
  * Check sha argument
  *
- * @param arg the arg to check
+ * @param arg the arg to check. Can also be a git_oid_vector with one
+ * oid.
  * @return 0 if OK, else -1
  */
 int attribute_hidden
@@ -267,6 +268,9 @@ git2r_arg_check_sha(
 {
     size_t len;
 
+    if (!git2r_arg_check_oid_vector(arg))
+        return Rf_xlength(arg) == GIT_OID_RAWSZ ? 0 : -1;
+
     if (git2r_arg_check_string(arg))
         return -1;
 
@@ -362,6 +366,25 @@ git2r_arg_check_note(
     return 0;
 }
 
+/**
+ * Check git_oid_vector argument
+ *
+ * @param arg the arg to check
+ * @return 0 if OK, else -1
+ */
+int attribute_hidden
+git2r_arg_check_oid_vector(
+    SEXP arg)
+{
+    if (TYPEOF(arg) != RAWSXP || !Rf_inherits(arg, "git_oid_vector"))
+        return -1;
+
+    if (Rf_xlength(arg) % GIT_OID_RAWSZ)
+        return -1;
+
+    return 0;
+}
+
 /**
  * Check real argument
  *
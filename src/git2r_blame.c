@@ -17,11 +17,15 @@
  */
 
 #include <R_ext/Visibility.h>
+#include <stdlib.h>
+#include <string.h>
 #include <git2.h>
 
 #include "git2r_arg.h"
 #include "git2r_blame.h"
 #include "git2r_error.h"
+#include "git2r_log.h"
+#include "git2r_oid.h"
 #include "git2r_repository.h"
 #include "git2r_S3.h"
 #include "git2r_signature.h"
@@ -86,15 +90,19 @@ git2r_blame_init(
                 git2r_S3_item__git_blame_hunk__final_start_line_number,
                 Rf_ScalarInteger((int)(hunk->final_start_line_number)));
 
-            SET_VECTOR_ELT(
-                item,
-                git2r_S3_item__git_blame_hunk__final_signature,
-                signature = Rf_mkNamed(VECSXP, git2r_S3_items__git_signature));
-            Rf_setAttrib(
-                signature,
-                R_ClassSymbol,
-                Rf_mkString(git2r_S3_class__git_signature));
-            git2r_signature_init(hunk->final_signature, signature);
+            /* The lines of a buffer that are not committed have no
+             * signature. */
+            if (hunk->final_signature) {
+                SET_VECTOR_ELT(
+                    item,
+                    git2r_S3_item__git_blame_hunk__final_signature,
+                    signature = Rf_mkNamed(VECSXP, git2r_S3_items__git_signature));
+                Rf_setAttrib(
+                    signature,
+                    R_ClassSymbol,
+                    Rf_mkString(git2r_S3_class__git_signature));
+                git2r_signature_init(hunk->final_signature, signature);
+            }
 
             git_oid_fmt(sha, &(hunk->orig_commit_id));
             sha[GIT_OID_HEXSZ] = '\0';
@@ -108,13 +116,15 @@ git2r_blame_init(
                 git2r_S3_item__git_blame_hunk__orig_start_line_number,
                 Rf_ScalarInteger((int)(hunk->orig_start_line_number)));
 
-            SET_VECTOR_ELT(
-                item,
-                git2r_S3_item__git_blame_hunk__orig_signature,
-                signature = Rf_mkNamed(VECSXP, git2r_S3_items__git_signature));
-            Rf_setAttrib(signature, R_ClassSymbol,
-                         Rf_mkString(git2r_S3_class__git_signature));
-            git2r_signature_init(hunk->orig_signature, signature);
+            if (hunk->orig_signature) {
+                SET_VECTOR_ELT(
+                    item,
+                    git2r_S3_item__git_blame_hunk__orig_signature,
+                    signature = Rf_mkNamed(VECSXP, git2r_S3_items__git_signature));
+                Rf_setAttrib(signature, R_ClassSymbol,
+                             Rf_mkString(git2r_S3_class__git_signature));
+                git2r_signature_init(hunk->orig_signature, signature);
+            }
 
             SET_VECTOR_ELT(
                 item,
@@ -144,17 +154,188 @@ git2r_blame_init(
     SET_VECTOR_ELT(dest, git2r_S3_item__git_blame__repo, Rf_duplicate(repo));
 }
 
+/**
+ * Allocate the columns of the blame with one row per line, starting
+ * at column 'col' of the list.
+ *
+ * @param result The list with the columns.
+ * @param col The index of the 'line' column in the list.
+ * @param n_lines The number of lines.
+ * @param oid_vector If TRUE, list the sha's as a git_oid_vector.
+ * @return void
+ */
+static void
+git2r_blame_lines_alloc(
+    SEXP result,
+    int col,
+    R_xlen_t n_lines,
+    int oid_vector)
+{
+    SET_VECTOR_ELT(result, col, Rf_allocVector(INTSXP, n_lines));
+    if (oid_vector) {
+        SET_VECTOR_ELT(result, col + 1, git2r_oid_vector_alloc(n_lines));
+        SET_VECTOR_ELT(result, col + 2, git2r_oid_vector_alloc(n_lines));
+    } else {
+        SET_VECTOR_ELT(result, col + 1, Rf_allocVector(STRSXP, n_lines));
+        SET_VECTOR_ELT(result, col + 2, Rf_allocVector(STRSXP, n_lines));
+    }
+    SET_VECTOR_ELT(result, col + 3, Rf_allocVector(INTSXP, n_lines));
+    SET_VECTOR_ELT(result, col + 4, Rf_allocVector(STRSXP, n_lines));
+    SET_VECTOR_ELT(result, col + 5, Rf_allocVector(STRSXP, n_lines));
+    SET_VECTOR_ELT(result, col + 6, Rf_allocVector(STRSXP, n_lines));
+    SET_VECTOR_ELT(result, col + 7, Rf_allocVector(REALSXP, n_lines));
+    SET_VECTOR_ELT(result, col + 8, Rf_allocVector(LGLSXP, n_lines));
+}
+
+/**
+ * Fill the rows of the lines in a hunk in the columns of the
+ * blame. The strings of the hunk are created once and shared by all
+ * lines in the hunk.
+ *
+ * @param result The list with the columns.
+ * @param col The index of the 'line' column in the list.
+ * @param row The row of the first line in the hunk.
+ * @param hunk The hunk.
+ * @param oid_vector If TRUE, list the sha's as a git_oid_vector.
+ * @return void
+ */
+static void
+git2r_blame_lines_hunk(
+    SEXP result,
+    int col,
+    R_xlen_t row,
+    const git_blame_hunk *hunk,
+    int oid_vector)
+{
+    const git_signature *signature = hunk->final_signature;
+    char hex[GIT_OID_HEXSZ + 1];
+    SEXP final_id = NA_STRING, orig_id = NA_STRING;
+    SEXP orig_path, name = NA_STRING, email = NA_STRING;
+    double when = NA_REAL;
+    R_xlen_t j;
+
+    /* The zero oid of lines that are not committed is NA, as in a
+     * git_oid_vector. */
+    if (!oid_vector && !git_oid_is_zero(&(hunk->final_commit_id))) {
+        git_oid_tostr(hex, sizeof(hex), &(hunk->final_commit_id));
+        final_id = Rf_mkChar(hex);
+    }
+    PROTECT(final_id);
+    if (!oid_vector && !git_oid_is_zero(&(hunk->orig_commit_id))) {
+        git_oid_tostr(hex, sizeof(hex), &(hunk->orig_commit_id));
+        orig_id = Rf_mkChar(hex);
+    }
+    PROTECT(orig_id);
+    PROTECT(orig_path = hunk->orig_path ?
+            Rf_mkChar(hunk->orig_path) : NA_STRING);
+    if (signature) {
+        name = Rf_mkChar(signature->name);
+        when = (double)signature->when.time;
+    }
+    PROTECT(name);
+    if (signature)
+        email = Rf_mkChar(signature->email);
+    PROTECT(email);
+
+    for (j = 0; j < (R_xlen_t)hunk->lines_in_hunk; j++, row++) {
+        INTEGER(VECTOR_ELT(result, col))[row] =
+            (int)(hunk->final_start_line_number + j);
+        if (oid_vector) {
+            git2r_oid_vector_set(VECTOR_ELT(result, col + 1), row,
+                                 &(hunk->final_commit_id));
+            git2r_oid_vector_set(VECTOR_ELT(result, col + 2), row,
+                                 &(hunk->orig_commit_id));
+        } else {
+            SET_STRING_ELT(VECTOR_ELT(result, col + 1), row, final_id);
+            SET_STRING_ELT(VECTOR_ELT(result, col + 2), row, orig_id);
+        }
+        INTEGER(VECTOR_ELT(result, col + 3))[row] =
+            (int)(hunk->orig_start_line_number + j);
+        SET_STRING_ELT(VECTOR_ELT(result, col + 4), row, orig_path);
+        SET_STRING_ELT(VECTOR_ELT(result, col + 5), row, name);
+        SET_STRING_ELT(VECTOR_ELT(result, col + 6), row, email);
+        REAL(VECTOR_ELT(result, col + 7))[row] = when;
+        LOGICAL(VECTOR_ELT(result, col + 8))[row] = hunk->boundary ? 1 : 0;
+    }
+
+    UNPROTECT(5);
+}
+
+/**
+ * Create a list with the columns of the blame, with one row per line
+ * in the final version of the file.
+ *
+ * The number of lines is known from the hunks, so the columns are
+ * allocated once and filled hunk by hunk.
+ * @param source a blame object
+ * @param oid_vector If TRUE, list the sha's as a git_oid_vector.
+ * @return A named list with the columns of the blame.
+ */
+static SEXP
+git2r_blame_lines(
+    git_blame *source,
+    int oid_vector)
+{
+    const char *names[] = {"line", "final_commit_id", "orig_commit_id",
+                           "orig_line", "orig_path", "author", "email",
+                           "when", "boundary", ""};
+    SEXP result;
+    uint32_t i, n;
+    R_xlen_t row = 0, n_lines = 0;
+
+    n = git_blame_get_hunk_count(source);
+    for (i = 0; i < n; i++) {
+        const git_blame_hunk *hunk = git_blame_get_hunk_byindex(source, i);
+        if (hunk)
+            n_lines += hunk->lines_in_hunk;
+    }
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    git2r_blame_lines_alloc(result, 0, n_lines, oid_vector);
+
+    for (i = 0; i < n; i++) {
+        const git_blame_hunk *hunk = git_blame_get_hunk_byindex(source, i);
+
+        if (!hunk)
+            continue;
+        git2r_blame_lines_hunk(result, 0, row, hunk, oid_vector);
+        row += hunk->lines_in_hunk;
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
 /**
  * Get the blame for a single file
  *
  * @param repo S3 class git_repository that contains the blob
  * @param path The path to the file to get the blame
- * @return S3 class git_blame
+ * @param lines If TRUE, return a list with the columns of the blame
+ * with one row per line, else the S3 class git_blame.
+ * @param oid_vector If TRUE and lines is TRUE, list the sha's as a
+ * git_oid_vector.
+ * @param min_line The first line in the file to blame, or 0 to start
+ * at the first line.
+ * @param max_line The last line in the file to blame, or 0 to stop at
+ * the last line.
+ * @param newest_commit The sha of the newest commit to consider, or
+ * R_NilValue to start at HEAD.
+ * @param oldest_commit The sha of the oldest commit to consider, or
+ * R_NilValue to continue to the root commits.
+ * @return S3 class git_blame or a list with the columns of the blame.
  */
 SEXP attribute_hidden
 git2r_blame_file(
     SEXP repo,
-    SEXP path)
+    SEXP path,
+    SEXP lines,
+    SEXP oid_vector,
+    SEXP min_line,
+    SEXP max_line,
+    SEXP newest_commit,
+    SEXP oldest_commit)
 {
     int error, nprotect = 0;
     SEXP result = R_NilValue;
@@ -164,6 +345,25 @@ git2r_blame_file(
 
     if (git2r_arg_check_string(path))
         git2r_error(__func__, NULL, "'path'", git2r_err_string_arg);
+    if (git2r_arg_check_logical(lines))
+        git2r_error(__func__, NULL, "'lines'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(oid_vector))
+        git2r_error(__func__, NULL, "'oid_vector'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer_gte_zero(min_line))
+        git2r_error(__func__, NULL, "'min_line'", git2r_err_integer_gte_zero_arg);
+    if (git2r_arg_check_integer_gte_zero(max_line))
+        git2r_error(__func__, NULL, "'max_line'", git2r_err_integer_gte_zero_arg);
+    if (!Rf_isNull(newest_commit) && git2r_arg_check_sha(newest_commit))
+        git2r_error(__func__, NULL, "'newest_commit'", git2r_err_sha_arg);
+    if (!Rf_isNull(oldest_commit) && git2r_arg_check_sha(oldest_commit))
+        git2r_error(__func__, NULL, "'oldest_commit'", git2r_err_sha_arg);
+
+    blame_opts.min_line = (size_t)INTEGER(min_line)[0];
+    blame_opts.max_line = (size_t)INTEGER(max_line)[0];
+    if (!Rf_isNull(newest_commit))
+        git2r_oid_from_sha_sexp(newest_commit, &(blame_opts.newest_commit));
+    if (!Rf_isNull(oldest_commit))
+        git2r_oid_from_sha_sexp(oldest_commit, &(blame_opts.oldest_commit));
 
     repository = git2r_repository_open(repo);
     if (!repository)
@@ -177,19 +377,629 @@ git2r_blame_file(
     if (error)
         goto cleanup;
 
-    PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_blame));
-    nprotect++;
-    Rf_setAttrib(result, R_ClassSymbol,
-                 Rf_mkString(git2r_S3_class__git_blame));
-    git2r_blame_init(blame, repo, path, result);
+    if (LOGICAL(lines)[0]) {
+        PROTECT(result = git2r_blame_lines(blame, LOGICAL(oid_vector)[0]));
+        nprotect++;
+    } else {
+        PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_blame));
+        nprotect++;
+        Rf_setAttrib(result, R_ClassSymbol,
+                     Rf_mkString(git2r_S3_class__git_blame));
+        git2r_blame_init(blame, repo, path, result);
+    }
+
+cleanup:
+    git_blame_free(blame);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Blame of a committed file at HEAD, kept in the session as the
+ * reference for the blame of buffers. The blame refers to the
+ * repository handle, which is shared by the entries of the same
+ * repository and freed with the last of them.
+ */
+typedef struct {
+    char *gitdir;
+    char *path;
+    git_oid head;
+    git_repository *repository;
+    git_blame *blame;
+    unsigned long last_used;
+} git2r_blame_cache_entry;
+
+/**
+ * Session-scoped cache with the blame of files at HEAD. When the
+ * cache is full, the least recently used blame is evicted.
+ */
+#define GIT2R_BLAME_CACHE_SIZE 32
+
+static struct {
+    git2r_blame_cache_entry *entries;
+    size_t n;
+    unsigned long tick;
+} git2r_blame_cache = {NULL, 0, 0};
+
+/**
+ * Find the repository handle that the entries of a repository share.
+ *
+ * @param gitdir The path to the repository.
+ * @return The repository handle, or NULL if no entry has it.
+ */
+static git_repository*
+git2r_blame_cache_repository(
+    const char *gitdir)
+{
+    size_t i;
+
+    for (i = 0; i < git2r_blame_cache.n; i++) {
+        if (!strcmp(git2r_blame_cache.entries[i].gitdir, gitdir))
+            return git2r_blame_cache.entries[i].repository;
+    }
+
+    return NULL;
+}
+
+static void
+git2r_blame_cache_remove(
+    size_t i)
+{
+    size_t j;
+    int shared = 0;
+    git2r_blame_cache_entry *entry = &git2r_blame_cache.entries[i];
+
+    for (j = 0; j < git2r_blame_cache.n; j++) {
+        if (j != i && git2r_blame_cache.entries[j].repository == entry->repository)
+            shared = 1;
+    }
+
+    git_blame_free(entry->blame);
+    if (!shared)
+        git_repository_free(entry->repository);
+    free(entry->gitdir);
+    free(entry->path);
+
+    git2r_blame_cache.n--;
+    if (i < git2r_blame_cache.n) {
+        memmove(&git2r_blame_cache.entries[i],
+                &git2r_blame_cache.entries[i + 1],
+                (git2r_blame_cache.n - i) * sizeof(git2r_blame_cache_entry));
+    }
+}
+
+/**
+ * Get the blame of a file at HEAD from the cache. The blame is
+ * created and added to the cache if it is not in the cache, or if
+ * HEAD has moved since it was created.
+ *
+ * @param out Pointer to the cached blame.
+ * @param repository The repository.
+ * @param path The path to the file.
+ * @return 0 or an error code.
+ */
+static int
+git2r_blame_cache_get(
+    git_blame **out,
+    git_repository *repository,
+    const char *path)
+{
+    int error;
+    size_t i;
+    const char *gitdir = git_repository_path(repository);
+    git_oid head;
+    git_blame_options blame_opts = GIT_BLAME_OPTIONS_INIT;
+    git2r_blame_cache_entry entry;
+    git_repository *shared = NULL;
+
+    error = git_reference_name_to_id(&head, repository, "HEAD");
+    if (error)
+        return error;
+
+    for (i = 0; i < git2r_blame_cache.n; i++) {
+        git2r_blame_cache_entry *e = &git2r_blame_cache.entries[i];
+
+        if (!strcmp(e->gitdir, gitdir) && !strcmp(e->path, path)) {
+            if (git_oid_equal(&(e->head), &head)) {
+                e->last_used = ++git2r_blame_cache.tick;
+                *out = e->blame;
+                return 0;
+            }
+
+            git2r_blame_cache_remove(i);
+            break;
+        }
+    }
+
+    /* Evict before the shared handle is looked up, since removing the
+     * last entry of the repository frees the handle. */
+    if (git2r_blame_cache.n >= GIT2R_BLAME_CACHE_SIZE) {
+        size_t lru = 0;
+
+        for (i = 1; i < git2r_blame_cache.n; i++) {
+            if (git2r_blame_cache.entries[i].last_used <
+                git2r_blame_cache.entries[lru].last_used)
+                lru = i;
+        }
+
+        git2r_blame_cache_remove(lru);
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    git_oid_cpy(&(entry.head), &head);
+    entry.gitdir = malloc(strlen(gitdir) + 1);
+    entry.path = malloc(strlen(path) + 1);
+    if (!entry.gitdir || !entry.path) {
+        giterr_set_oom();
+        error = GIT_ERROR_NOMEMORY;
+        goto cleanup;
+    }
+    strcpy(entry.gitdir, gitdir);
+    strcpy(entry.path, path);
+
+    shared = git2r_blame_cache_repository(gitdir);
+    if (shared) {
+        entry.repository = shared;
+    } else {
+        error = git_repository_open(&(entry.repository), gitdir);
+        if (error)
+            goto cleanup;
+    }
+
+    git_oid_cpy(&(blame_opts.newest_commit), &head);
+    error = git_blame_file(&(entry.blame), entry.repository, path, &blame_opts);
+    if (error)
+        goto cleanup;
+
+    i = git2r_blame_cache.n;
+    if (i % 8 == 0) {
+        git2r_blame_cache_entry *entries = realloc(
+            git2r_blame_cache.entries, (i + 8) * sizeof(git2r_blame_cache_entry));
+        if (!entries) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+        git2r_blame_cache.entries = entries;
+    }
+    entry.last_used = ++git2r_blame_cache.tick;
+    git2r_blame_cache.entries[i] = entry;
+    git2r_blame_cache.n++;
+    *out = entry.blame;
+
+    return 0;
+
+cleanup:
+    git_blame_free(entry.blame);
+    if (!shared)
+        git_repository_free(entry.repository);
+    free(entry.gitdir);
+    free(entry.path);
+
+    return error;
+}
+
+/**
+ * Free all blames in the cache of blames at HEAD.
+ */
+void attribute_hidden
+git2r_blame_cache_free(void)
+{
+    while (git2r_blame_cache.n)
+        git2r_blame_cache_remove(git2r_blame_cache.n - 1);
+    free(git2r_blame_cache.entries);
+    git2r_blame_cache.entries = NULL;
+}
+
+/**
+ * Remove the blames of the files in a repository, or of all
+ * repositories, from the cache.
+ *
+ * @param repo S3 class git_repository, or R_NilValue to clear the
+ * cache.
+ * @return R_NilValue
+ */
+SEXP attribute_hidden
+git2r_blame_cache_clear(
+    SEXP repo)
+{
+    size_t i;
+    const char *gitdir;
+    git_repository *repository;
+
+    if (Rf_isNull(repo)) {
+        git2r_blame_cache_free();
+        return R_NilValue;
+    }
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    gitdir = git_repository_path(repository);
+    for (i = git2r_blame_cache.n; i > 0; i--) {
+        if (!strcmp(git2r_blame_cache.entries[i - 1].gitdir, gitdir))
+            git2r_blame_cache_remove(i - 1);
+    }
+
+    git2r_repository_close(repository);
+
+    return R_NilValue;
+}
+
+/**
+ * Get the blame for the content of a file that is not committed
+ *
+ * The blame of the committed file at HEAD is kept in the session,
+ * and the content is blamed with git_blame_buffer on top of it. The
+ * blame at HEAD is created again when HEAD has moved.
+ * @param repo S3 class git_repository that contains the file
+ * @param path The path to the file to get the blame
+ * @param buffer The content of the file
+ * @param lines If TRUE, return a list with the columns of the blame
+ * with one row per line, else the S3 class git_blame.
+ * @param oid_vector If TRUE and lines is TRUE, list the sha's as a
+ * git_oid_vector.
+ * @return S3 class git_blame or a list with the columns of the blame.
+ */
+SEXP attribute_hidden
+git2r_blame_buffer(
+    SEXP repo,
+    SEXP path,
+    SEXP buffer,
+    SEXP lines,
+    SEXP oid_vector)
+{
+    int error, nprotect = 0;
+    SEXP result = R_NilValue;
+    git_blame *reference = NULL, *blame = NULL;
+    git_repository *repository = NULL;
+
+    if (git2r_arg_check_string(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_arg);
+    if (git2r_arg_check_string(buffer))
+        git2r_error(__func__, NULL, "'buffer'", git2r_err_string_arg);
+    if (git2r_arg_check_logical(lines))
+        git2r_error(__func__, NULL, "'lines'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(oid_vector))
+        git2r_error(__func__, NULL, "'oid_vector'", git2r_err_logical_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    error = git2r_blame_cache_get(
+        &reference,
+        repository,
+        CHAR(STRING_ELT(path, 0)));
+    if (error)
+        goto cleanup;
+
+    error = git_blame_buffer(
+        &blame,
+        reference,
+        CHAR(STRING_ELT(buffer, 0)),
+        (size_t)LENGTH(STRING_ELT(buffer, 0)));
+    if (error)
+        goto cleanup;
+
+    if (LOGICAL(lines)[0]) {
+        PROTECT(result = git2r_blame_lines(blame, LOGICAL(oid_vector)[0]));
+        nprotect++;
+    } else {
+        PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_blame));
+        nprotect++;
+        Rf_setAttrib(result, R_ClassSymbol,
+                     Rf_mkString(git2r_S3_class__git_blame));
+        git2r_blame_init(blame, repo, path, result);
+    }
 
 cleanup:
     git_blame_free(blame);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * The blame of a file. The hunks are written by the thread that
+ * blames the file, and read by the main thread when all files are
+ * done.
+ */
+typedef struct {
+    git_blame_hunk *hunks;
+    size_t n;
+    size_t n_lines;
+    char *error;
+} git2r_blame_files_file;
+
+static void
+git2r_blame_files_file_free(
+    git2r_blame_files_file *file)
+{
+    size_t i;
+
+    for (i = 0; i < file->n; i++) {
+        free((char*)file->hunks[i].orig_path);
+        git_signature_free(file->hunks[i].final_signature);
+    }
+    free(file->hunks);
+    free(file->error);
+    memset(file, 0, sizeof(git2r_blame_files_file));
+}
+
+/**
+ * Blame a file and copy the hunks to native memory, so that the
+ * blame can be freed together with the repository handle of the
+ * thread. Only the fields that are listed in the columns of the
+ * blame are copied.
+ *
+ * @param out The file to write the hunks to
+ * @param repository The repository with the file
+ * @param path The path to the file
+ * @param opts The blame options
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_blame_files_blame(
+    git2r_blame_files_file *out,
+    git_repository *repository,
+    const char *path,
+    git_blame_options *opts)
+{
+    int error;
+    uint32_t i, n;
+    git_blame *blame = NULL;
+
+    error = git_blame_file(&blame, repository, path, opts);
+    if (error)
+        return error;
+
+    n = git_blame_get_hunk_count(blame);
+    if (n) {
+        out->hunks = calloc(n, sizeof(git_blame_hunk));
+        if (!out->hunks) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        const git_blame_hunk *hunk = git_blame_get_hunk_byindex(blame, i);
+        git_blame_hunk *h = &out->hunks[out->n];
+
+        if (!hunk)
+            continue;
+        out->n++;
+
+        h->lines_in_hunk = hunk->lines_in_hunk;
+        h->final_start_line_number = hunk->final_start_line_number;
+        h->orig_start_line_number = hunk->orig_start_line_number;
+        git_oid_cpy(&h->final_commit_id, &hunk->final_commit_id);
+        git_oid_cpy(&h->orig_commit_id, &hunk->orig_commit_id);
+        h->boundary = hunk->boundary;
+        if (hunk->orig_path) {
+            char *orig_path = malloc(strlen(hunk->orig_path) + 1);
+            if (!orig_path) {
+                giterr_set_oom();
+                error = GIT_ERROR_NOMEMORY;
+                goto cleanup;
+            }
+            strcpy(orig_path, hunk->orig_path);
+            h->orig_path = orig_path;
+        }
+        if (hunk->final_signature) {
+            error = git_signature_dup(&h->final_signature,
+                                      hunk->final_signature);
+            if (error)
+                goto cleanup;
+        }
+        out->n_lines += h->lines_in_hunk;
+    }
+
+cleanup:
+    git_blame_free(blame);
+
+    return error;
+}
+
+/**
+ * Blame files, with the files split over 'n_threads' threads. Every
+ * thread opens its own handle of the repository and doesn't call the
+ * R API. An error is kept as a message on the file that failed.
+ *
+ * @param files The blames of the files
+ * @param paths The paths to the files
+ * @param n_paths The number of files
+ * @param repo_path The path to the repository
+ * @param opts The blame options
+ * @param n_threads The number of threads
+ */
+static void
+git2r_blame_files_run(
+    git2r_blame_files_file *files,
+    const char **paths,
+    size_t n_paths,
+    const char *repo_path,
+    git_blame_options *opts,
+    int n_threads)
+{
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(n_threads)
+#endif
+    {
+        long i, n = (long)n_paths;
+        git_repository *repository = NULL;
+        int error = git_repository_open(&repository, repo_path);
+
+        /* The cost of a blame varies a lot between files, so the
+         * files are handed out one at a time. */
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for (i = 0; i < n; i++) {
+            if (!error) {
+                error = git2r_blame_files_blame(
+                    &files[i], repository, paths[i], opts);
+            }
+
+            if (error) {
+                const git_error *err = git_error_last();
+                const char *msg = (err && err->message) ? err->message :
+                    "Unable to blame file";
+
+                files[i].error = malloc(strlen(msg) + 1);
+                if (files[i].error)
+                    strcpy(files[i].error, msg);
+                if (repository)
+                    error = 0;
+            }
+        }
+
+        git_repository_free(repository);
+    }
+
+    GIT2R_UNUSED(n_threads);
+}
+
+/**
+ * Get the blame for many files, with one row per line
+ *
+ * The files are blamed in parallel by 'nthreads' threads when git2r
+ * is built with OpenMP, and the blames are combined into one list of
+ * columns in the order of the paths.
+ * @param repo S3 class git_repository that contains the files
+ * @param path The paths to the files to get the blame
+ * @param newest_commit The sha of the newest commit to consider, or
+ * R_NilValue to start at HEAD.
+ * @param oldest_commit The sha of the oldest commit to consider, or
+ * R_NilValue to continue to the root commits.
+ * @param oid_vector If TRUE, list the sha's as a git_oid_vector.
+ * @param nthreads The number of threads to use, or 0 to use one
+ * thread per processor.
+ * @return A named list with the columns of the blame.
+ */
+SEXP attribute_hidden
+git2r_blame_files(
+    SEXP repo,
+    SEXP path,
+    SEXP newest_commit,
+    SEXP oldest_commit,
+    SEXP oid_vector,
+    SEXP nthreads)
+{
+    const char *names[] = {"path", "line", "final_commit_id",
+                           "orig_commit_id", "orig_line", "orig_path",
+                           "author", "email", "when", "boundary", ""};
+    int error = GIT_OK, nprotect = 0;
+    SEXP result = R_NilValue;
+    size_t i, n_paths, n_lines = 0;
+    R_xlen_t row = 0;
+    char *msg = NULL;
+    const char **paths = NULL;
+    git_repository *repository = NULL;
+    git_blame_options blame_opts = GIT_BLAME_OPTIONS_INIT;
+    git2r_blame_files_file *files = NULL;
+
+    if (git2r_arg_check_string_vec(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+    if (!Rf_isNull(newest_commit) && git2r_arg_check_sha(newest_commit))
+        git2r_error(__func__, NULL, "'newest_commit'", git2r_err_sha_arg);
+    if (!Rf_isNull(oldest_commit) && git2r_arg_check_sha(oldest_commit))
+        git2r_error(__func__, NULL, "'oldest_commit'", git2r_err_sha_arg);
+    if (git2r_arg_check_logical(oid_vector))
+        git2r_error(__func__, NULL, "'oid_vector'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer_gte_zero(nthreads))
+        git2r_error(__func__, NULL, "'nthreads'", git2r_err_integer_gte_zero_arg);
+
+    if (!Rf_isNull(newest_commit))
+        git2r_oid_from_sha_sexp(newest_commit, &(blame_opts.newest_commit));
+    if (!Rf_isNull(oldest_commit))
+        git2r_oid_from_sha_sexp(oldest_commit, &(blame_opts.oldest_commit));
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    n_paths = (size_t)Rf_xlength(path);
+    if (n_paths) {
+        files = calloc(n_paths, sizeof(git2r_blame_files_file));
+        paths = malloc(n_paths * sizeof(char*));
+        if (!files || !paths) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+        for (i = 0; i < n_paths; i++)
+            paths[i] = CHAR(STRING_ELT(path, i));
+    }
+
+    /* Use the repository handle of the main thread to resolve HEAD
+     * once, so that all files are blamed at the same commit. */
+    if (Rf_isNull(newest_commit)) {
+        error = git_reference_name_to_id(
+            &(blame_opts.newest_commit), repository, "HEAD");
+        if (error)
+            goto cleanup;
+    }
+
+    git2r_blame_files_run(
+        files, paths, n_paths, git_repository_path(repository),
+        &blame_opts, git2r_log_nthreads(nthreads));
+
+    for (i = 0; i < n_paths; i++) {
+        if (files[i].error) {
+            msg = R_alloc(strlen(files[i].error) + 1, sizeof(char));
+            strcpy(msg, files[i].error);
+            goto cleanup;
+        }
+        n_lines += files[i].n_lines;
+    }
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    nprotect++;
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n_lines));
+    git2r_blame_lines_alloc(result, 1, n_lines, LOGICAL(oid_vector)[0]);
+
+    for (i = 0; i < n_paths; i++) {
+        size_t j, k;
+        SEXP file_path = STRING_ELT(path, i);
+
+        for (j = 0; j < files[i].n; j++) {
+            const git_blame_hunk *hunk = &files[i].hunks[j];
+
+            git2r_blame_lines_hunk(result, 1, row, hunk, LOGICAL(oid_vector)[0]);
+            for (k = 0; k < hunk->lines_in_hunk; k++, row++)
+                SET_STRING_ELT(VECTOR_ELT(result, 0), row, file_path);
+        }
+    }
+
+cleanup:
+    for (i = 0; files && i < n_paths; i++)
+        git2r_blame_files_file_free(&files[i]);
+    free(files);
+    free(paths);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
 
+    if (msg)
+        git2r_error(__func__, NULL, msg, NULL);
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
 
@@ -22,6 +22,14 @@
 #include <R.h>
 #include <Rinternals.h>
 
-SEXP git2r_blame_file(SEXP repo, SEXP path);
+SEXP git2r_blame_buffer(SEXP repo, SEXP path, SEXP buffer, SEXP lines,
+                        SEXP oid_vector);
+SEXP git2r_blame_cache_clear(SEXP repo);
+void git2r_blame_cache_free(void);
+SEXP git2r_blame_files(SEXP repo, SEXP path, SEXP newest_commit,
+                       SEXP oldest_commit, SEXP oid_vector, SEXP nthreads);
+SEXP git2r_blame_file(SEXP repo, SEXP path, SEXP lines, SEXP oid_vector,
+                      SEXP min_line, SEXP max_line, SEXP newest_commit,
+                      SEXP oldest_commit);
 
 #endif
@@ -17,24 +17,78 @@
  */
 
 #include <R_ext/Visibility.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "git2r_arg.h"
 #include "git2r_blob.h"
 #include "git2r_error.h"
 #include "git2r_repository.h"
 #include "git2r_S3.h"
 
+/**
+ * Split text into lines at '\n', like 'strsplit(x, "\n")' in R: an
+ * empty text gives no lines and a trailing '\n' doesn't give an
+ * empty last line.
+ *
+ * @param text The text
+ * @param len The number of bytes in text
+ * @param max_n The maximum number of lines to split, or -1 for all
+ * lines.
+ * @param consumed The number of bytes in the lines that were split,
+ * including the '\n'. Can be NULL.
+ * @return A STRSXP with the lines, or R_NilValue if the lines
+ * contain a NUL byte, which a CHARSXP cannot hold.
+ */
+static SEXP
+git2r_blob_split_lines(
+    const char *text,
+    size_t len,
+    R_xlen_t max_n,
+    size_t *consumed)
+{
+    SEXP result;
+    R_xlen_t i, n = 0;
+    size_t pos;
+
+    /* Count the lines before creating the vector. */
+    for (pos = 0; pos < len && (max_n < 0 || n < max_n); n++) {
+        const char *eol = memchr(text + pos, '\n', len - pos);
+        pos = eol ? (size_t)(eol - text) + 1 : len;
+    }
+    if (memchr(text, '\0', pos))
+        return R_NilValue;
+
+    PROTECT(result = Rf_allocVector(STRSXP, n));
+    for (i = 0, pos = 0; i < n; i++) {
+        const char *eol = memchr(text + pos, '\n', len - pos);
+        size_t end = eol ? (size_t)(eol - text) : len;
+        SET_STRING_ELT(result, i, Rf_mkCharLen(text + pos, (int)(end - pos)));
+        pos = eol ? end + 1 : len;
+    }
+    UNPROTECT(1);
+
+    if (consumed)
+        *consumed = pos;
+
+    return result;
+}
+
 /**
  * Get content of a blob
  *
  * @param blob S3 class git_blob
  * @param raw If true, return content as a RAWSXP vector, else as a
  * STRSXP vector.
+ * @param split If true, and raw is false, split the content into
+ * lines directly from the blob buffer.
  * @return content
  */
 SEXP attribute_hidden
 git2r_blob_content(
     SEXP blob,
-    SEXP raw)
+    SEXP raw,
+    SEXP split)
 {
     int error, nprotect = 0;
     SEXP result = R_NilValue;
@@ -47,6 +101,8 @@ git2r_blob_content(
         git2r_error(__func__, NULL, "'blob'", git2r_err_blob_arg);
     if (git2r_arg_check_logical(raw))
         git2r_error(__func__, NULL, "'raw'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(split))
+        git2r_error(__func__, NULL, "'split'", git2r_err_logical_arg);
 
     repository = git2r_repository_open(git2r_get_list_element(blob, "repo"));
     if (!repository)
@@ -66,19 +122,32 @@ git2r_blob_content(
             RAW(result),
             git_blob_rawcontent(blob_obj),
             git_blob_rawsize(blob_obj));
-    } else {
+    } else if (git_blob_is_binary(blob_obj)) {
         PROTECT(result = Rf_allocVector(STRSXP, 1));
         nprotect++;
-        if (git_blob_is_binary(blob_obj)) {
-            SET_STRING_ELT(result, 0, NA_STRING);
+        SET_STRING_ELT(result, 0, NA_STRING);
+    } else {
+        const char *text = git_blob_rawcontent(blob_obj);
+        size_t len = (size_t)git_blob_rawsize(blob_obj);
+        const char *nul = memchr(text, '\0', len);
+
+        /* The text ends at the first NUL, if any. */
+        if (nul)
+            len = (size_t)(nul - text);
+
+        if (LOGICAL(split)[0]) {
+            PROTECT(result = git2r_blob_split_lines(text, len, -1, NULL));
+            nprotect++;
         } else {
-            SET_STRING_ELT(result, 0, Rf_mkChar(git_blob_rawcontent(blob_obj)));
+            PROTECT(result = Rf_allocVector(STRSXP, 1));
+            nprotect++;
+            SET_STRING_ELT(result, 0, Rf_mkCharLen(text, (int)len));
         }
     }
 
 cleanup:
     git_blob_free(blob_obj);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -89,6 +158,204 @@ cleanup:
     return result;
 }
 
+/**
+ * The state of a blob reader. The blob is kept in memory, inflated
+ * once, while the reader is open. The reader owns its repository
+ * handle, since the blob refers to it across calls from R, and a
+ * cached handle can be removed from the cache between the calls.
+ */
+typedef struct {
+    git_repository *repository;
+    git_blob *blob;
+    size_t pos;
+} git2r_blob_reader;
+
+static void
+git2r_blob_reader_free(
+    git2r_blob_reader *reader)
+{
+    if (!reader)
+        return;
+    git_blob_free(reader->blob);
+    git_repository_free(reader->repository);
+    free(reader);
+}
+
+static void
+git2r_blob_reader_finalize(
+    SEXP reader)
+{
+    git2r_blob_reader_free(R_ExternalPtrAddr(reader));
+    R_ClearExternalPtr(reader);
+}
+
+/**
+ * Get the state of an open blob reader
+ *
+ * @param reader The external pointer of the reader
+ * @return The state of the reader, or NULL if the argument is not an
+ * open blob reader.
+ */
+static git2r_blob_reader*
+git2r_blob_reader_get(
+    SEXP reader)
+{
+    if (TYPEOF(reader) != EXTPTRSXP ||
+        R_ExternalPtrTag(reader) != Rf_install("git_blob_reader"))
+        return NULL;
+    return R_ExternalPtrAddr(reader);
+}
+
+/**
+ * Open a reader to read the content of a blob in chunks or in
+ * batches of lines.
+ *
+ * @param blob S3 class git_blob
+ * @return An external pointer to the reader
+ */
+SEXP attribute_hidden
+git2r_blob_reader_open(
+    SEXP blob)
+{
+    int error;
+    SEXP result = R_NilValue, repo, sha;
+    git_oid oid;
+    git2r_blob_reader *reader = NULL;
+
+    if (git2r_arg_check_blob(blob))
+        git2r_error(__func__, NULL, "'blob'", git2r_err_blob_arg);
+
+    repo = git2r_get_list_element(blob, "repo");
+    if (git2r_arg_check_repository(repo))
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    reader = calloc(1, sizeof(git2r_blob_reader));
+    if (!reader)
+        git2r_error(__func__, NULL, git2r_err_alloc_memory_buffer, NULL);
+
+    error = git_repository_open(
+        &reader->repository,
+        CHAR(STRING_ELT(git2r_get_list_element(repo, "path"), 0)));
+    if (!error) {
+        sha = git2r_get_list_element(blob, "sha");
+        git_oid_fromstr(&oid, CHAR(STRING_ELT(sha, 0)));
+        error = git_blob_lookup(&reader->blob, reader->repository, &oid);
+    }
+    if (error) {
+        git2r_blob_reader_free(reader);
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+    }
+
+    PROTECT(result = R_MakeExternalPtr(reader, Rf_install("git_blob_reader"),
+                                       R_NilValue));
+    R_RegisterCFinalizerEx(result, git2r_blob_reader_finalize, TRUE);
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Close a blob reader and release the blob.
+ *
+ * @param reader The external pointer of the reader
+ * @return R_NilValue
+ */
+SEXP attribute_hidden
+git2r_blob_reader_close(
+    SEXP reader)
+{
+    if (TYPEOF(reader) != EXTPTRSXP)
+        git2r_error(__func__, NULL, "'reader'", git2r_err_blob_reader_arg);
+    git2r_blob_reader_finalize(reader);
+
+    return R_NilValue;
+}
+
+/**
+ * Read a chunk of bytes from a blob reader
+ *
+ * @param reader The external pointer of the reader
+ * @param n The maximum number of bytes to read
+ * @param offset The offset in bytes to read from, or NA to read from
+ * the current position of the reader.
+ * @return A RAWSXP with the bytes, of length zero at the end of the
+ * blob.
+ */
+SEXP attribute_hidden
+git2r_blob_reader_read(
+    SEXP reader,
+    SEXP n,
+    SEXP offset)
+{
+    SEXP result;
+    size_t size, len;
+    double max_n, pos;
+    git2r_blob_reader *r = git2r_blob_reader_get(reader);
+
+    if (!r)
+        git2r_error(__func__, NULL, "'reader'", git2r_err_blob_reader_arg);
+    max_n = Rf_asReal(n);
+    if (!R_FINITE(max_n) || max_n < 0)
+        git2r_error(__func__, NULL, "'n'", git2r_err_number_gte_zero_arg);
+    pos = Rf_asReal(offset);
+    if (!ISNA(pos) && (!R_FINITE(pos) || pos < 0))
+        git2r_error(__func__, NULL, "'offset'", git2r_err_number_gte_zero_arg);
+
+    size = (size_t)git_blob_rawsize(r->blob);
+    if (!ISNA(pos))
+        r->pos = pos < (double)size ? (size_t)pos : size;
+
+    len = size - r->pos;
+    if (max_n < (double)len)
+        len = (size_t)max_n;
+
+    PROTECT(result = Rf_allocVector(RAWSXP, len));
+    if (len)
+        memcpy(RAW(result), (const char*)git_blob_rawcontent(r->blob) + r->pos, len);
+    r->pos += len;
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Read a batch of lines from a blob reader
+ *
+ * Lines with a NUL byte, e.g. in a binary blob, raise an error and
+ * the position of the reader is unchanged, so the bytes can be read
+ * with git2r_blob_reader_read instead.
+ * @param reader The external pointer of the reader
+ * @param n The maximum number of lines to read
+ * @return A STRSXP with the lines, of length zero at the end of the
+ * blob.
+ */
+SEXP attribute_hidden
+git2r_blob_reader_lines(
+    SEXP reader,
+    SEXP n)
+{
+    size_t consumed;
+    SEXP result;
+    git2r_blob_reader *r = git2r_blob_reader_get(reader);
+
+    if (!r)
+        git2r_error(__func__, NULL, "'reader'", git2r_err_blob_reader_arg);
+    if (git2r_arg_check_integer_gte_zero(n))
+        git2r_error(__func__, NULL, "'n'", git2r_err_integer_gte_zero_arg);
+
+    PROTECT(result = git2r_blob_split_lines(
+                (const char*)git_blob_rawcontent(r->blob) + r->pos,
+                (size_t)git_blob_rawsize(r->blob) - r->pos,
+                INTEGER(n)[0],
+                &consumed));
+    if (Rf_isNull(result))
+        git2r_error(__func__, NULL, git2r_err_blob_nul, NULL);
+    r->pos += consumed;
+    UNPROTECT(1);
+
+    return result;
+}
+
 /**
  * Read a file from the filesystem and write its content to the
  * Object Database as a loose blob
@@ -144,7 +411,7 @@ git2r_blob_create_fromdisk(
     }
 
 cleanup:
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -214,7 +481,7 @@ git2r_blob_create_fromworkdir(
     }
 
 cleanup:
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -288,7 +555,7 @@ git2r_blob_is_binary(
 
 cleanup:
     git_blob_free(blob_obj);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -334,7 +601,7 @@ git2r_blob_rawsize(
 
 cleanup:
     git_blob_free(blob_obj);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
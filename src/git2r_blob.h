@@ -23,11 +23,15 @@
 #include <Rinternals.h>
 #include <git2.h>
 
-SEXP git2r_blob_content(SEXP blob, SEXP raw);
+SEXP git2r_blob_content(SEXP blob, SEXP raw, SEXP split);
 SEXP git2r_blob_create_fromdisk(SEXP repo, SEXP path);
 SEXP git2r_blob_create_fromworkdir(SEXP repo, SEXP relative_path);
 void git2r_blob_init(const git_blob *source, SEXP repo, SEXP dest);
 SEXP git2r_blob_is_binary(SEXP blob);
 SEXP git2r_blob_rawsize(SEXP blob);
+SEXP git2r_blob_reader_close(SEXP reader);
+SEXP git2r_blob_reader_lines(SEXP reader, SEXP n);
+SEXP git2r_blob_reader_open(SEXP blob);
+SEXP git2r_blob_reader_read(SEXP reader, SEXP n, SEXP offset);
 
 #endif
@@ -0,0 +1,890 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2026 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/** @file git2r_bloom.c
+ *  @brief Changed-path Bloom filters for path-limited history walks
+ *
+ *  For every commit, a Bloom filter with the paths (and the leading
+ *  directories of the paths) that changed compared to the first
+ *  parent is kept in the file 'git2r-changed-paths' in the git
+ *  directory. The filters use the same parameters as the changed-path
+ *  Bloom filters in the commit-graph of git: murmur3 hashing with
+ *  seeds 0x293ae76f and 0x7e646e2c, 7 hashes and 10 bits per
+ *  entry. Commits with more than 512 changed paths get a filter that
+ *  matches every path.
+ *
+ *  File format, with integers in network byte order:
+ *
+ *    header:  "G2RB", version, number of hashes, bits per entry,
+ *             number of commits (5 x 4 bytes)
+ *    index:   one record per commit sorted by oid: the raw oid
+ *             (20 bytes) and the end offset of the filter in the
+ *             data section (4 bytes)
+ *    data:    the concatenated filters
+ */
+
+#include <R_ext/Visibility.h>
+#include <git2.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "git2r_arg.h"
+#include "git2r_bloom.h"
+#include "git2r_error.h"
+#include "git2r_repository.h"
+
+#define GIT2R_BLOOM_FILENAME "git2r-changed-paths"
+#define GIT2R_BLOOM_SIGNATURE "G2RB"
+#define GIT2R_BLOOM_VERSION 1
+#define GIT2R_BLOOM_NUM_HASHES 7
+#define GIT2R_BLOOM_BITS_PER_ENTRY 10
+#define GIT2R_BLOOM_MAX_CHANGED_PATHS 512
+#define GIT2R_BLOOM_HEADER_SIZE 20
+#define GIT2R_BLOOM_RECORD_SIZE (GIT_OID_RAWSZ + 4)
+
+/**
+ * The filter of one commit in the data buffer.
+ */
+typedef struct {
+    git_oid oid;
+    size_t offset;
+    size_t len;
+} git2r_bloom_entry;
+
+/**
+ * The changed-path Bloom filters of a repository. The first
+ * 'n_sorted' entries are sorted by oid and found with a binary
+ * search; entries computed afterwards are appended and found through
+ * an open-addressing hash table, so that the lookup of every commit
+ * in a long walk stays constant. 'modified' is set when entries have
+ * been added since the index was read or written.
+ */
+struct git2r_bloom_index {
+    char *filename;
+    git_repository *repository;
+    git2r_bloom_entry *entries;
+    size_t n;
+    size_t n_sorted;
+    size_t size;
+    size_t *slots; /* One-based index, or 0 for an empty slot. */
+    size_t mask;
+    int modified;
+    unsigned char *data;
+    size_t data_len;
+    size_t data_size;
+};
+
+static uint32_t
+git2r_bloom_get_be32(
+    const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void
+git2r_bloom_put_be32(
+    unsigned char *p,
+    uint32_t value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+#define GIT2R_ROTL32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+/**
+ * 32-bit murmur3 hash.
+ *
+ * @param seed The seed of the hash.
+ * @param data The data to hash.
+ * @param len The number of bytes in data.
+ * @return The hash value.
+ */
+static uint32_t
+git2r_bloom_murmur3(
+    uint32_t seed,
+    const char *data,
+    size_t len)
+{
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    const unsigned char *p = (const unsigned char*)data;
+    size_t i, nblocks = len / 4;
+    uint32_t h = seed, k;
+
+    for (i = 0; i < nblocks; i++, p += 4) {
+        k = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+            ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        k *= c1;
+        k = GIT2R_ROTL32(k, 15);
+        k *= c2;
+        h ^= k;
+        h = GIT2R_ROTL32(h, 13);
+        h = h * 5 + 0xe6546b64;
+    }
+
+    k = 0;
+    switch (len & 3) {
+    case 3:
+        k ^= (uint32_t)p[2] << 16;
+        /* fall through */
+    case 2:
+        k ^= (uint32_t)p[1] << 8;
+        /* fall through */
+    case 1:
+        k ^= (uint32_t)p[0];
+        k *= c1;
+        k = GIT2R_ROTL32(k, 15);
+        k *= c2;
+        h ^= k;
+    }
+
+    h ^= (uint32_t)len;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+/**
+ * Set or test the bits of a path in a filter.
+ *
+ * @param filter The filter.
+ * @param len The number of bytes in the filter.
+ * @param path The path.
+ * @param path_len The number of bytes in the path.
+ * @param set Set the bits if non-zero, else test them.
+ * @return 1 if all bits are set, else 0.
+ */
+static int
+git2r_bloom_filter_bits(
+    unsigned char *filter,
+    size_t len,
+    const char *path,
+    size_t path_len,
+    int set)
+{
+    uint32_t h0, h1;
+    uint64_t nbits = (uint64_t)len * 8;
+    int i;
+
+    if (!len)
+        return 0;
+
+    h0 = git2r_bloom_murmur3(0x293ae76f, path, path_len);
+    h1 = git2r_bloom_murmur3(0x7e646e2c, path, path_len);
+
+    for (i = 0; i < GIT2R_BLOOM_NUM_HASHES; i++) {
+        uint64_t pos = (uint32_t)(h0 + i * h1) % nbits;
+        unsigned char mask = (unsigned char)(1 << (pos % 8));
+
+        if (set)
+            filter[pos / 8] |= mask;
+        else if (!(filter[pos / 8] & mask))
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Check if a path can be looked up in the filters, i.e. if it is a
+ * normalized path relative to the working directory without any
+ * wildcards.
+ *
+ * @param path The path.
+ * @return 1 if the path is literal, else 0.
+ */
+int attribute_hidden
+git2r_bloom_path_is_literal(
+    const char *path)
+{
+    const char *p;
+
+    if (!path || !*path || *path == '!' || strpbrk(path, "*?[\\"))
+        return 0;
+
+    /* Reject empty, '.' and '..' path components. */
+    for (p = path; ; ) {
+        size_t len = strcspn(p, "/");
+        if (!len || (len == 1 && p[0] == '.') ||
+            (len == 2 && p[0] == '.' && p[1] == '.'))
+            return 0;
+        if (!p[len])
+            break;
+        p += len + 1;
+    }
+
+    return 1;
+}
+
+static int
+git2r_bloom_strcmp(
+    const void *a,
+    const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static int
+git2r_bloom_entry_cmp(
+    const void *a,
+    const void *b)
+{
+    return git_oid_cmp(&((const git2r_bloom_entry*)a)->oid,
+                       &((const git2r_bloom_entry*)b)->oid);
+}
+
+/**
+ * Find the slot of an appended entry in the hash table. The oids are
+ * uniformly distributed, so the first bytes of the oid are used as
+ * the hash.
+ *
+ * @param index The Bloom filter index.
+ * @param oid The id of the commit.
+ * @return The slot, which is empty if the commit is not in the
+ * table.
+ */
+static size_t*
+git2r_bloom_index_slot(
+    git2r_bloom_index *index,
+    const git_oid *oid)
+{
+    size_t h;
+
+    memcpy(&h, oid->id, sizeof(h));
+    for (h &= index->mask;; h = (h + 1) & index->mask) {
+        size_t *slot = &index->slots[h];
+
+        if (!*slot || git_oid_equal(&index->entries[*slot - 1].oid, oid))
+            return slot;
+    }
+}
+
+/**
+ * Grow the hash table so that it has room for one more appended
+ * entry, with a load factor of at most one half.
+ *
+ * @param index The Bloom filter index.
+ * @return 0 on success, else -1.
+ */
+static int
+git2r_bloom_index_reserve(
+    git2r_bloom_index *index)
+{
+    size_t i, size, n = index->n - index->n_sorted + 1;
+
+    if (index->slots && 2 * n <= index->mask + 1)
+        return 0;
+
+    size = index->slots ? 2 * (index->mask + 1) : 1024;
+    free(index->slots);
+    index->slots = calloc(size, sizeof(size_t));
+    if (!index->slots)
+        return -1;
+    index->mask = size - 1;
+
+    for (i = index->n_sorted; i < index->n; i++)
+        *git2r_bloom_index_slot(index, &index->entries[i].oid) = i + 1;
+
+    return 0;
+}
+
+/**
+ * Find the filter of a commit.
+ *
+ * @param index The Bloom filter index.
+ * @param oid The id of the commit.
+ * @return The entry or NULL if the commit is not in the index.
+ */
+static git2r_bloom_entry*
+git2r_bloom_index_find(
+    git2r_bloom_index *index,
+    const git_oid *oid)
+{
+    size_t *slot;
+    git2r_bloom_entry key;
+
+    git_oid_cpy(&key.oid, oid);
+    if (index->n_sorted) {
+        git2r_bloom_entry *entry = bsearch(
+            &key, index->entries, index->n_sorted,
+            sizeof(git2r_bloom_entry), git2r_bloom_entry_cmp);
+        if (entry)
+            return entry;
+    }
+
+    if (!index->slots)
+        return NULL;
+    slot = git2r_bloom_index_slot(index, oid);
+
+    return *slot ? &index->entries[*slot - 1] : NULL;
+}
+
+/**
+ * Append a new zeroed filter to the index.
+ *
+ * @param index The Bloom filter index.
+ * @param oid The id of the commit.
+ * @param len The number of bytes in the filter.
+ * @return The new entry or NULL if out of memory.
+ */
+static git2r_bloom_entry*
+git2r_bloom_index_append(
+    git2r_bloom_index *index,
+    const git_oid *oid,
+    size_t len)
+{
+    git2r_bloom_entry *entry;
+
+    if (git2r_bloom_index_reserve(index))
+        return NULL;
+
+    if (index->n == index->size) {
+        size_t size = index->size ? 2 * index->size : 1024;
+        git2r_bloom_entry *entries =
+            realloc(index->entries, size * sizeof(git2r_bloom_entry));
+        if (!entries)
+            return NULL;
+        index->entries = entries;
+        index->size = size;
+    }
+
+    if (index->data_len + len > index->data_size) {
+        size_t size = index->data_size ? 2 * index->data_size : 65536;
+        unsigned char *data;
+        while (size < index->data_len + len)
+            size *= 2;
+        data = realloc(index->data, size);
+        if (!data)
+            return NULL;
+        index->data = data;
+        index->data_size = size;
+    }
+
+    entry = &index->entries[index->n++];
+    git_oid_cpy(&entry->oid, oid);
+    entry->offset = index->data_len;
+    entry->len = len;
+    memset(index->data + entry->offset, 0, len);
+    index->data_len += len;
+    *git2r_bloom_index_slot(index, oid) = index->n;
+    index->modified = 1;
+
+    return entry;
+}
+
+/**
+ * Compute the filter of a commit from the diff against the first
+ * parent, or against the empty tree for a root commit.
+ *
+ * @param out The new entry, or NULL if the parent of the commit is
+ * missing, e.g. in a shallow clone.
+ * @param index The Bloom filter index.
+ * @param commit The commit.
+ * @return 0 on success, or an error code.
+ */
+static int
+git2r_bloom_index_compute(
+    git2r_bloom_entry **out,
+    git2r_bloom_index *index,
+    git_commit *commit)
+{
+    int error;
+    size_t i, j, n = 0, n_deltas, n_unique = 0, len;
+    char **paths = NULL;
+    git_commit *parent = NULL;
+    git_tree *a = NULL, *b = NULL;
+    git_diff *diff = NULL;
+    git2r_bloom_entry *entry;
+
+    *out = NULL;
+
+    if (git_commit_parentcount(commit)) {
+        error = git_commit_parent(&parent, commit, 0);
+        if (error == GIT_ENOTFOUND) {
+            error = GIT_OK;
+            goto cleanup;
+        }
+        if (error)
+            goto cleanup;
+        if ((error = git_commit_tree(&a, parent)) < 0)
+            goto cleanup;
+    }
+    if ((error = git_commit_tree(&b, commit)) < 0)
+        goto cleanup;
+    error = git_diff_tree_to_tree(&diff, index->repository, a, b, NULL);
+    if (error)
+        goto cleanup;
+
+    n_deltas = git_diff_num_deltas(diff);
+    if (n_deltas > GIT2R_BLOOM_MAX_CHANGED_PATHS) {
+        /* A filter that matches every path. */
+        entry = git2r_bloom_index_append(index, git_commit_id(commit), 1);
+        if (!entry)
+            goto oom;
+        index->data[entry->offset] = 0xff;
+        *out = entry;
+        goto cleanup;
+    }
+
+    /* Collect the changed paths and their leading directories. */
+    for (i = 0; i < n_deltas; i++) {
+        const char *path = git_diff_get_delta(diff, i)->new_file.path;
+        for (j = 0; path[j]; j++) {
+            if (path[j] == '/')
+                n++;
+        }
+        n++;
+    }
+
+    if (n) {
+        paths = calloc(n, sizeof(char*));
+        if (!paths)
+            goto oom;
+    }
+
+    for (i = 0, n = 0; i < n_deltas; i++) {
+        const char *path = git_diff_get_delta(diff, i)->new_file.path;
+        for (j = 0; ; j++) {
+            if (path[j] == '/' || !path[j]) {
+                paths[n] = malloc(j + 1);
+                if (!paths[n])
+                    goto oom;
+                memcpy(paths[n], path, j);
+                paths[n++][j] = '\0';
+            }
+            if (!path[j])
+                break;
+        }
+    }
+
+    if (n) {
+        qsort(paths, n, sizeof(char*), git2r_bloom_strcmp);
+        for (i = 0; i < n; i++) {
+            if (!i || strcmp(paths[i - 1], paths[i]))
+                n_unique++;
+        }
+    }
+
+    if (n_unique > GIT2R_BLOOM_MAX_CHANGED_PATHS) {
+        entry = git2r_bloom_index_append(index, git_commit_id(commit), 1);
+        if (!entry)
+            goto oom;
+        index->data[entry->offset] = 0xff;
+        *out = entry;
+        goto cleanup;
+    }
+
+    len = (n_unique * GIT2R_BLOOM_BITS_PER_ENTRY + 7) / 8;
+    entry = git2r_bloom_index_append(index, git_commit_id(commit), len);
+    if (!entry)
+        goto oom;
+    for (i = 0; i < n; i++) {
+        git2r_bloom_filter_bits(index->data + entry->offset, len,
+                                paths[i], strlen(paths[i]), 1);
+    }
+    *out = entry;
+    goto cleanup;
+
+oom:
+    giterr_set_oom();
+    error = GIT_ERROR_NOMEMORY;
+
+cleanup:
+    if (paths) {
+        for (i = 0; i < n; i++)
+            free(paths[i]);
+        free(paths);
+    }
+    git_diff_free(diff);
+    git_tree_free(a);
+    git_tree_free(b);
+    git_commit_free(parent);
+
+    return error;
+}
+
+/**
+ * Read the index file.
+ *
+ * An index file that cannot be parsed is ignored, and is replaced
+ * when the index is written.
+ *
+ * @param index The Bloom filter index.
+ * @param fp The opened index file.
+ */
+static void
+git2r_bloom_index_read(
+    git2r_bloom_index *index,
+    FILE *fp)
+{
+    unsigned char header[GIT2R_BLOOM_HEADER_SIZE];
+    unsigned char *records = NULL;
+    size_t i, n, end = 0;
+
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header))
+        return;
+    if (memcmp(header, GIT2R_BLOOM_SIGNATURE, 4) ||
+        git2r_bloom_get_be32(header + 4) != GIT2R_BLOOM_VERSION ||
+        git2r_bloom_get_be32(header + 8) != GIT2R_BLOOM_NUM_HASHES ||
+        git2r_bloom_get_be32(header + 12) != GIT2R_BLOOM_BITS_PER_ENTRY)
+        return;
+
+    n = git2r_bloom_get_be32(header + 16);
+    if (!n)
+        return;
+
+    records = malloc(n * GIT2R_BLOOM_RECORD_SIZE);
+    index->entries = malloc(n * sizeof(git2r_bloom_entry));
+    if (!records || !index->entries)
+        goto fail;
+    index->size = n;
+    if (fread(records, GIT2R_BLOOM_RECORD_SIZE, n, fp) != n)
+        goto fail;
+
+    for (i = 0; i < n; i++) {
+        const unsigned char *record = records + i * GIT2R_BLOOM_RECORD_SIZE;
+        size_t next = git2r_bloom_get_be32(record + GIT_OID_RAWSZ);
+
+        if (next < end)
+            goto fail;
+        memcpy(index->entries[i].oid.id, record, GIT_OID_RAWSZ);
+        index->entries[i].offset = end;
+        index->entries[i].len = next - end;
+        end = next;
+    }
+
+    index->data = malloc(end ? end : 1);
+    if (!index->data)
+        goto fail;
+    index->data_size = end ? end : 1;
+    if (end && fread(index->data, 1, end, fp) != end)
+        goto fail;
+    index->data_len = end;
+    index->n = n;
+    index->n_sorted = n;
+    free(records);
+
+    return;
+
+fail:
+    free(records);
+    free(index->entries);
+    free(index->data);
+    index->entries = NULL;
+    index->data = NULL;
+    index->size = 0;
+    index->data_size = 0;
+}
+
+/**
+ * Open the changed-path Bloom filter index of a repository.
+ *
+ * @param out The index, or NULL if the repository has no index or
+ * if the index cannot be used.
+ * @param repository The repository.
+ * @param create Create an empty index if the repository has no
+ * index. If zero, the index is not used for repositories with
+ * 'core.ignorecase' set.
+ * @return 0 on success, or an error code.
+ */
+int attribute_hidden
+git2r_bloom_index_open(
+    git2r_bloom_index **out,
+    git_repository *repository,
+    int create)
+{
+    const char *dir = git_repository_commondir(repository);
+    git2r_bloom_index *index;
+    FILE *fp;
+
+    *out = NULL;
+
+    /* The filters are case-sensitive, so don't use them when paths
+     * are matched case-insensitively. */
+    if (!create) {
+        int ignorecase = 0;
+        git_config *cfg = NULL;
+
+        if (!git_repository_config_snapshot(&cfg, repository)) {
+            if (git_config_get_bool(&ignorecase, cfg, "core.ignorecase"))
+                ignorecase = 0;
+            git_config_free(cfg);
+        }
+        if (ignorecase)
+            return GIT_OK;
+    }
+
+    index = calloc(1, sizeof(git2r_bloom_index));
+    if (!index)
+        goto oom;
+    index->repository = repository;
+    index->filename = malloc(strlen(dir) + sizeof(GIT2R_BLOOM_FILENAME));
+    if (!index->filename)
+        goto oom;
+    strcpy(index->filename, dir);
+    strcat(index->filename, GIT2R_BLOOM_FILENAME);
+
+    fp = fopen(index->filename, "rb");
+    if (fp) {
+        git2r_bloom_index_read(index, fp);
+        fclose(fp);
+    } else if (!create) {
+        git2r_bloom_index_free(index);
+        return GIT_OK;
+    }
+
+    *out = index;
+
+    return GIT_OK;
+
+oom:
+    git2r_bloom_index_free(index);
+    giterr_set_oom();
+    return GIT_ERROR_NOMEMORY;
+}
+
+/**
+ * Check if a commit may have changed a path compared to its first
+ * parent. The filter of the commit is computed and added to the
+ * index if the commit is not in the index.
+ *
+ * @param out 0 if the commit did not change the path, else 1.
+ * @param index The Bloom filter index.
+ * @param commit The commit.
+ * @param path The literal path to check.
+ * @return 0 on success, or an error code.
+ */
+int attribute_hidden
+git2r_bloom_index_maybe(
+    int *out,
+    git2r_bloom_index *index,
+    git_commit *commit,
+    const char *path)
+{
+    int error;
+    git2r_bloom_entry *entry;
+
+    *out = 1;
+
+    entry = git2r_bloom_index_find(index, git_commit_id(commit));
+    if (!entry) {
+        error = git2r_bloom_index_compute(&entry, index, commit);
+        if (error || !entry)
+            return error;
+    }
+
+    *out = git2r_bloom_filter_bits(index->data + entry->offset, entry->len,
+                                   path, strlen(path), 0);
+
+    return GIT_OK;
+}
+
+/**
+ * Write the index to disk if filters have been added. The index is
+ * first written to a temporary file that then replaces the index
+ * file.
+ *
+ * @param index The Bloom filter index.
+ * @return 0 on success, else -1.
+ */
+int attribute_hidden
+git2r_bloom_index_write(
+    git2r_bloom_index *index)
+{
+    int error = -1;
+    size_t i, end = 0;
+    unsigned char buf[GIT2R_BLOOM_RECORD_SIZE];
+    char *tmp = NULL;
+    FILE *fp = NULL;
+
+    if (!index->modified)
+        return 0;
+
+    if (index->n > UINT32_MAX || index->data_len > UINT32_MAX)
+        return -1;
+
+    /* All entries are sorted after this, so the appended entries are
+     * found with the binary search instead of the hash table. */
+    qsort(index->entries, index->n, sizeof(git2r_bloom_entry),
+          git2r_bloom_entry_cmp);
+    index->n_sorted = index->n;
+    free(index->slots);
+    index->slots = NULL;
+    index->mask = 0;
+
+    tmp = malloc(strlen(index->filename) + sizeof(".lock"));
+    if (!tmp)
+        goto cleanup;
+    strcpy(tmp, index->filename);
+    strcat(tmp, ".lock");
+
+    fp = fopen(tmp, "wb");
+    if (!fp)
+        goto cleanup;
+
+    memcpy(buf, GIT2R_BLOOM_SIGNATURE, 4);
+    git2r_bloom_put_be32(buf + 4, GIT2R_BLOOM_VERSION);
+    git2r_bloom_put_be32(buf + 8, GIT2R_BLOOM_NUM_HASHES);
+    git2r_bloom_put_be32(buf + 12, GIT2R_BLOOM_BITS_PER_ENTRY);
+    git2r_bloom_put_be32(buf + 16, (uint32_t)index->n);
+    if (fwrite(buf, 1, GIT2R_BLOOM_HEADER_SIZE, fp) != GIT2R_BLOOM_HEADER_SIZE)
+        goto cleanup;
+
+    for (i = 0; i < index->n; i++) {
+        end += index->entries[i].len;
+        memcpy(buf, index->entries[i].oid.id, GIT_OID_RAWSZ);
+        git2r_bloom_put_be32(buf + GIT_OID_RAWSZ, (uint32_t)end);
+        if (fwrite(buf, 1, GIT2R_BLOOM_RECORD_SIZE, fp) != GIT2R_BLOOM_RECORD_SIZE)
+            goto cleanup;
+    }
+
+    for (i = 0; i < index->n; i++) {
+        const git2r_bloom_entry *entry = &index->entries[i];
+        if (entry->len &&
+            fwrite(index->data + entry->offset, 1, entry->len, fp) != entry->len)
+            goto cleanup;
+    }
+
+    error = fclose(fp);
+    fp = NULL;
+    if (error)
+        goto cleanup;
+
+    remove(index->filename);
+    error = rename(tmp, index->filename);
+    if (!error)
+        index->modified = 0;
+
+cleanup:
+    if (fp) {
+        fclose(fp);
+        remove(tmp);
+    } else if (error && tmp) {
+        remove(tmp);
+    }
+    free(tmp);
+
+    return error ? -1 : 0;
+}
+
+/**
+ * Free the Bloom filter index.
+ *
+ * @param index The Bloom filter index. Can be NULL.
+ */
+void attribute_hidden
+git2r_bloom_index_free(
+    git2r_bloom_index *index)
+{
+    if (!index)
+        return;
+    free(index->filename);
+    free(index->entries);
+    free(index->slots);
+    free(index->data);
+    free(index);
+}
+
+/**
+ * Create or update the changed-path Bloom filter index with all
+ * commits reachable from HEAD and the references in the repository.
+ *
+ * @param repo S3 class git_repository
+ * @return The number of commits in the index.
+ */
+SEXP attribute_hidden
+git2r_bloom_index_update(
+    SEXP repo)
+{
+    int error = GIT_OK, write_failed = 0;
+    size_t n = 0;
+    git_oid oid;
+    git_revwalk *walker = NULL;
+    git_repository *repository = NULL;
+    git2r_bloom_index *index = NULL;
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    error = git2r_bloom_index_open(&index, repository, 1);
+    if (error)
+        goto cleanup;
+
+    if (git_repository_is_empty(repository))
+        goto cleanup;
+
+    error = git_revwalk_new(&walker, repository);
+    if (error)
+        goto cleanup;
+    error = git_revwalk_push_head(walker);
+    if (error == GIT_EUNBORNBRANCH || error == GIT_ENOTFOUND)
+        error = GIT_OK;
+    if (error)
+        goto cleanup;
+    error = git_revwalk_push_glob(walker, "*");
+    if (error)
+        goto cleanup;
+
+    while (!(error = git_revwalk_next(&oid, walker))) {
+        git_commit *commit;
+        git2r_bloom_entry *entry;
+
+        if (git2r_bloom_index_find(index, &oid))
+            continue;
+
+        error = git_commit_lookup(&commit, repository, &oid);
+        if (error)
+            goto cleanup;
+        error = git2r_bloom_index_compute(&entry, index, commit);
+        git_commit_free(commit);
+        if (error)
+            goto cleanup;
+    }
+    if (error == GIT_ITEROVER)
+        error = GIT_OK;
+    if (error)
+        goto cleanup;
+
+    if (git2r_bloom_index_write(index))
+        write_failed = 1;
+
+cleanup:
+    if (index)
+        n = index->n;
+    git2r_bloom_index_free(index);
+    git_revwalk_free(walker);
+    git2r_repository_close(repository);
+
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+    if (write_failed)
+        git2r_error(__func__, NULL, git2r_err_changed_paths_write, NULL);
+
+    return Rf_ScalarInteger((int)n);
+}
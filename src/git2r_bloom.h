@@ -0,0 +1,35 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2026 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDE_git2r_bloom_h
+#define INCLUDE_git2r_bloom_h
+
+#include <R.h>
+#include <Rinternals.h>
+#include <git2.h>
+
+typedef struct git2r_bloom_index git2r_bloom_index;
+
+int git2r_bloom_index_open(git2r_bloom_index **out, git_repository *repository, int create);
+int git2r_bloom_index_maybe(int *out, git2r_bloom_index *index, git_commit *commit, const char *path);
+int git2r_bloom_index_write(git2r_bloom_index *index);
+void git2r_bloom_index_free(git2r_bloom_index *index);
+int git2r_bloom_path_is_literal(const char *path);
+SEXP git2r_bloom_index_update(SEXP repo);
+
+#endif
@@ -157,7 +157,7 @@ git2r_branch_create(
 cleanup:
     git_reference_free(reference);
     git_commit_free(target);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -201,7 +201,7 @@ git2r_branch_delete(
 
 cleanup:
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
@@ -252,7 +252,7 @@ git2r_branch_is_head(
 
 cleanup:
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -332,7 +332,7 @@ git2r_branch_list(
 cleanup:
     git_branch_iterator_free(iter);
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -379,7 +379,7 @@ git2r_branch_canonical_name(
 
 cleanup:
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -464,7 +464,7 @@ cleanup:
     if (buf)
         free(buf);
     git_config_free(cfg);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -523,7 +523,7 @@ git2r_branch_remote_name(
 
 cleanup:
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -594,7 +594,7 @@ git2r_branch_remote_url(
 cleanup:
     git_remote_free(remote);
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -664,7 +664,7 @@ git2r_branch_rename(
 cleanup:
     git_reference_free(reference);
     git_reference_free(new_reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -718,7 +718,7 @@ git2r_branch_target(
 
 cleanup:
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -776,7 +776,7 @@ git2r_branch_get_upstream(
 cleanup:
     git_reference_free(reference);
     git_reference_free(upstream);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -832,7 +832,7 @@ git2r_branch_set_upstream(
 
 cleanup:
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
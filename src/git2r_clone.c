@@ -24,6 +24,7 @@
 #include "git2r_cred.h"
 #include "git2r_error.h"
 #include "git2r_proxy.h"
+#include "git2r_repository.h"
 #include "git2r_transfer.h"
 
 /**
@@ -152,6 +153,11 @@ git2r_clone(
                     CHAR(STRING_ELT(local_path, 0)),
                     &clone_opts);
 
+    if (!error) {
+        /* Drop stale handles to a previous repository at the path. */
+        git2r_repository_cache_invalidate(CHAR(STRING_ELT(local_path, 0)));
+        git2r_repository_cache_invalidate(git_repository_path(repository));
+    }
     git_repository_free(repository);
 
     if (error)
@@ -352,7 +352,7 @@ cleanup:
     git_signature_free(c_author);
     git_signature_free(c_committer);
     git_index_free(index);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
     git_commit_free(commit);
 
     if (nprotect)
@@ -428,7 +428,7 @@ git2r_commit_tree(
 cleanup:
     git_commit_free(commit_obj);
     git_tree_free(tree);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -557,7 +557,7 @@ git2r_commit_parent_list(
 
 cleanup:
     git_commit_free(commit_obj);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
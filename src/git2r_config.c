@@ -261,7 +261,7 @@ git2r_config_open(
         else
             error = git_repository_config(out, repository);
 
-        git_repository_free(repository);
+        git2r_repository_close(repository);
     } else if (snapshot) {
         git_config *config = NULL;
 
@@ -31,37 +31,51 @@
 #include <stdlib.h>
 #include <string.h>
 
-static int
-git2r_diff_count(
-    git_diff *diff, size_t *num_files,
-    size_t *max_hunks, size_t *max_lines);
-
 static int
 git2r_diff_format_to_r(
     git_diff *diff,
     SEXP dest);
 
+/**
+ * The format of a diff that is returned to R.
+ */
+typedef enum {
+    GIT2R_DIFF_FORMAT_S3 = 0,
+    GIT2R_DIFF_FORMAT_STATS,
+    GIT2R_DIFF_FORMAT_TABLE
+} git2r_diff_format_t;
+
+static int
+git2r_diff_columns_to_r(
+    git_diff *diff,
+    int format,
+    SEXP *out);
+
 SEXP git2r_diff_index_to_wd(
     SEXP repo,
     SEXP filename,
+    int format,
     git_diff_options *opts);
 
 SEXP
 git2r_diff_head_to_index(
     SEXP repo,
     SEXP filename,
+    int format,
     git_diff_options *opts);
 
 SEXP
 git2r_diff_tree_to_wd(
     SEXP tree,
     SEXP filename,
+    int format,
     git_diff_options *opts);
 
 SEXP
 git2r_diff_tree_to_index(
     SEXP tree,
     SEXP filename,
+    int format,
     git_diff_options *opts);
 
 SEXP
@@ -69,6 +83,7 @@ git2r_diff_tree_to_tree(
     SEXP tree1,
     SEXP tree2,
     SEXP filename,
+    int format,
     git_diff_options *opts);
 
 /**
@@ -115,6 +130,12 @@ git2r_diff_tree_to_tree(
  * @param max_size A size (in bytes) above which a blob will be
  * marked as binary automatically; pass a negative value to
  * disable. Defaults to 512MB when max_size is NULL.
+ * @param format The format of the diff when filename is R_NilValue:
+ * "git_diff" for a S3 class git_diff object, "stats" for a list with
+ * the columns path, status, additions, deletions and binary, with
+ * the line statistics per file, or "table" for a list with one row
+ * per line of the diff and the columns file, path, hunk, origin,
+ * old_lineno, new_lineno, num_lines and content.
  * @return A S3 class git_diff object if filename equals R_NilValue. A
  * character vector with diff if filename has length 0. Oterwise NULL.
  */
@@ -131,15 +152,29 @@ git2r_diff(
     SEXP new_prefix,
     SEXP id_abbrev,
     SEXP path,
-    SEXP max_size)
+    SEXP max_size,
+    SEXP format)
 {
-    int c_index;
+    int c_index, c_format = GIT2R_DIFF_FORMAT_S3;
     git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
 
     if (git2r_arg_check_logical(index))
         git2r_error(__func__, NULL, "'index'", git2r_err_logical_arg);
     c_index = LOGICAL(index)[0];
 
+    if (git2r_arg_check_string(format))
+        git2r_error(__func__, NULL, "'format'", git2r_err_string_arg);
+    if (!strcmp(CHAR(STRING_ELT(format, 0)), "git_diff"))
+        c_format = GIT2R_DIFF_FORMAT_S3;
+    else if (!strcmp(CHAR(STRING_ELT(format, 0)), "stats"))
+        c_format = GIT2R_DIFF_FORMAT_STATS;
+    else if (!strcmp(CHAR(STRING_ELT(format, 0)), "table"))
+        c_format = GIT2R_DIFF_FORMAT_TABLE;
+    else
+        git2r_error(__func__, NULL, git2r_err_diff_arg, NULL);
+    if (c_format != GIT2R_DIFF_FORMAT_S3)
+        filename = R_NilValue;
+
     if (git2r_arg_check_integer_gte_zero(context_lines))
         git2r_error(__func__, NULL, "'context_lines'", git2r_err_integer_gte_zero_arg);
     opts.context_lines = INTEGER(context_lines)[0];
@@ -185,30 +220,30 @@ git2r_diff(
     if (Rf_isNull(tree1) && ! c_index) {
 	if (!Rf_isNull(tree2))
 	    git2r_error(__func__, NULL, git2r_err_diff_arg, NULL);
-	return git2r_diff_index_to_wd(repo, filename, &opts);
+	return git2r_diff_index_to_wd(repo, filename, c_format, &opts);
     }
 
     if (Rf_isNull(tree1) && c_index) {
 	if (!Rf_isNull(tree2))
 	    git2r_error(__func__, NULL, git2r_err_diff_arg, NULL);
-	return git2r_diff_head_to_index(repo, filename, &opts);
+	return git2r_diff_head_to_index(repo, filename, c_format, &opts);
     }
 
     if (!Rf_isNull(tree1) && Rf_isNull(tree2) && !c_index) {
 	if (!Rf_isNull(repo))
 	    git2r_error(__func__, NULL, git2r_err_diff_arg, NULL);
-	return git2r_diff_tree_to_wd(tree1, filename, &opts);
+	return git2r_diff_tree_to_wd(tree1, filename, c_format, &opts);
     }
 
     if (!Rf_isNull(tree1) && Rf_isNull(tree2) && c_index) {
 	if (!Rf_isNull(repo))
 	    git2r_error(__func__, NULL, git2r_err_diff_arg, NULL);
-	return git2r_diff_tree_to_index(tree1, filename, &opts);
+	return git2r_diff_tree_to_index(tree1, filename, c_format, &opts);
     }
 
     if (!Rf_isNull(repo))
         git2r_error(__func__, NULL, git2r_err_diff_arg, NULL);
-    return git2r_diff_tree_to_tree(tree1, tree2, filename, &opts);
+    return git2r_diff_tree_to_tree(tree1, tree2, filename, c_format, &opts);
 }
 
 static int
@@ -249,6 +284,8 @@ git2r_diff_print_cb(
  * diff is written to a character vector. If filename is a character
  * vector of length one with non-NA value, the diff is written to a
  * file with name filename (the file is overwritten if it exists).
+ * @param format If not GIT2R_DIFF_FORMAT_S3, return the diff as a
+ * list of columns instead, see git2r_diff_columns_to_r.
  * @param opts Structure describing options about how the diff
  * should be executed.
  * @return A S3 class git_diff object if filename equals R_NilValue. A
@@ -258,6 +295,7 @@ SEXP attribute_hidden
 git2r_diff_index_to_wd(
     SEXP repo,
     SEXP filename,
+    int format,
     git_diff_options *opts)
 {
     int error, nprotect = 0;
@@ -280,7 +318,13 @@ git2r_diff_index_to_wd(
     if (error)
 	goto cleanup;
 
-    if (Rf_isNull(filename)) {
+    if (format != GIT2R_DIFF_FORMAT_S3) {
+        error = git2r_diff_columns_to_r(diff, format, &result);
+        if (!error) {
+            PROTECT(result);
+            nprotect++;
+        }
+    } else if (Rf_isNull(filename)) {
         PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff));
         nprotect++;
         Rf_setAttrib(result, R_ClassSymbol,
@@ -317,7 +361,7 @@ git2r_diff_index_to_wd(
 cleanup:
     free(opts->pathspec.strings);
     git_diff_free(diff);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -338,6 +382,8 @@ cleanup:
  * diff is written to a character vector. If filename is a character
  * vector of length one with non-NA value, the diff is written to a
  * file with name filename (the file is overwritten if it exists).
+ * @param format If not GIT2R_DIFF_FORMAT_S3, return the diff as a
+ * list of columns instead, see git2r_diff_columns_to_r.
  * @param opts Structure describing options about how the diff
  * should be executed.
  * @return A S3 class git_diff object if filename equals R_NilValue. A
@@ -347,6 +393,7 @@ SEXP attribute_hidden
 git2r_diff_head_to_index(
     SEXP repo,
     SEXP filename,
+    int format,
     git_diff_options *opts)
 {
     int error, nprotect = 0;
@@ -380,7 +427,13 @@ git2r_diff_head_to_index(
     if (error)
 	goto cleanup;
 
-    if (Rf_isNull(filename)) {
+    if (format != GIT2R_DIFF_FORMAT_S3) {
+        error = git2r_diff_columns_to_r(diff, format, &result);
+        if (!error) {
+            PROTECT(result);
+            nprotect++;
+        }
+    } else if (Rf_isNull(filename)) {
         /* TODO: object instead of HEAD string */
         PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff));
         nprotect++;
@@ -429,7 +482,7 @@ cleanup:
     git_tree_free(head);
     git_object_free(obj);
     git_diff_free(diff);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -450,6 +503,8 @@ cleanup:
  * diff is written to a character vector. If filename is a character
  * vector of length one with non-NA value, the diff is written to a
  * file with name filename (the file is overwritten if it exists).
+ * @param format If not GIT2R_DIFF_FORMAT_S3, return the diff as a
+ * list of columns instead, see git2r_diff_columns_to_r.
  * @param opts Structure describing options about how the diff
  * should be executed.
  * @return A S3 class git_diff object if filename equals R_NilValue. A
@@ -459,6 +514,7 @@ SEXP attribute_hidden
 git2r_diff_tree_to_wd(
     SEXP tree,
     SEXP filename,
+    int format,
     git_diff_options *opts)
 {
     int error, nprotect = 0;
@@ -493,7 +549,13 @@ git2r_diff_tree_to_wd(
     if (error)
 	goto cleanup;
 
-    if (Rf_isNull(filename)) {
+    if (format != GIT2R_DIFF_FORMAT_S3) {
+        error = git2r_diff_columns_to_r(diff, format, &result);
+        if (!error) {
+            PROTECT(result);
+            nprotect++;
+        }
+    } else if (Rf_isNull(filename)) {
         PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff));
         nprotect++;
         Rf_setAttrib(result, R_ClassSymbol,
@@ -541,7 +603,7 @@ cleanup:
     git_diff_free(diff);
     git_tree_free(c_tree);
     git_object_free(obj);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -562,6 +624,8 @@ cleanup:
  * diff is written to a character vector. If filename is a character
  * vector of length one with non-NA value, the diff is written to a
  * file with name filename (the file is overwritten if it exists).
+ * @param format If not GIT2R_DIFF_FORMAT_S3, return the diff as a
+ * list of columns instead, see git2r_diff_columns_to_r.
  * @param opts Structure describing options about how the diff
  * should be executed.
  * @return A S3 class git_diff object if filename equals R_NilValue. A
@@ -571,6 +635,7 @@ SEXP attribute_hidden
 git2r_diff_tree_to_index(
     SEXP tree,
     SEXP filename,
+    int format,
     git_diff_options *opts)
 {
     int error, nprotect = 0;
@@ -610,7 +675,13 @@ git2r_diff_tree_to_index(
     if (error)
 	goto cleanup;
 
-    if (Rf_isNull(filename)) {
+    if (format != GIT2R_DIFF_FORMAT_S3) {
+        error = git2r_diff_columns_to_r(diff, format, &result);
+        if (!error) {
+            PROTECT(result);
+            nprotect++;
+        }
+    } else if (Rf_isNull(filename)) {
         PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff));
         nprotect++;
         Rf_setAttrib(result, R_ClassSymbol,
@@ -658,7 +729,7 @@ cleanup:
     git_diff_free(diff);
     git_tree_free(c_tree);
     git_object_free(obj);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -680,6 +751,8 @@ cleanup:
  * diff is written to a character vector. If filename is a character
  * vector of length one with non-NA value, the diff is written to a
  * file with name filename (the file is overwritten if it exists).
+ * @param format If not GIT2R_DIFF_FORMAT_S3, return the diff as a
+ * list of columns instead, see git2r_diff_columns_to_r.
  * @param opts Structure describing options about how the diff
  * should be executed.
  * @return A S3 class git_diff object if filename equals R_NilValue. A
@@ -690,6 +763,7 @@ git2r_diff_tree_to_tree(
     SEXP tree1,
     SEXP tree2,
     SEXP filename,
+    int format,
     git_diff_options *opts)
 {
     int error, nprotect = 0;
@@ -744,7 +818,13 @@ git2r_diff_tree_to_tree(
     if (error)
 	goto cleanup;
 
-    if (Rf_isNull(filename)) {
+    if (format != GIT2R_DIFF_FORMAT_S3) {
+        error = git2r_diff_columns_to_r(diff, format, &result);
+        if (!error) {
+            PROTECT(result);
+            nprotect++;
+        }
+    } else if (Rf_isNull(filename)) {
         PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff));
         nprotect++;
         Rf_setAttrib(result, R_ClassSymbol,
@@ -794,7 +874,7 @@ cleanup:
     git_tree_free(c_tree2);
     git_object_free(obj1);
     git_object_free(obj2);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -806,144 +886,71 @@ cleanup:
 }
 
 /**
- * Data structure to hold the information when counting diff objects.
+ * A line of a diff, staged until the hunk is complete. The content
+ * is stored NUL-terminated in the content buffer of the payload.
  */
 typedef struct {
-    size_t num_files;
-    size_t max_hunks;
-    size_t max_lines;
-    size_t num_hunks;
-    size_t num_lines;
-} git2r_diff_count_payload;
+    int origin;
+    int old_lineno;
+    int new_lineno;
+    int num_lines;
+    size_t content;
+} git2r_diff_line_stage;
 
 /**
- * Callback per file in the diff
- *
- * @param delta A pointer to the delta data for the file
- * @param progress Goes from 0 to 1 over the diff
- * @param payload A pointer to the git2r_diff_count_payload data structure
- * @return 0
- */
-static int
-git2r_diff_count_file_cb(
-    const git_diff_delta *delta,
-    float progress,
-    void *payload)
-{
-    git2r_diff_count_payload *n = payload;
-
-    GIT2R_UNUSED(delta);
-    GIT2R_UNUSED(progress);
-
-    n->num_files += 1;
-    n->num_hunks = n->num_lines = 0;
-    return 0;
-}
-
-/**
- * Callback per hunk in the diff
- *
- * @param delta A pointer to the delta data for the file
- * @param hunk A pointer to the structure describing a hunk of a diff
- * @param payload A pointer to the git2r_diff_count_payload data structure
- * @return 0
- */
-static int
-git2r_diff_count_hunk_cb(
-    const git_diff_delta *delta,
-    const git_diff_hunk *hunk,
-    void *payload)
-{
-    git2r_diff_count_payload *n = payload;
-
-    GIT2R_UNUSED(delta);
-    GIT2R_UNUSED(hunk);
-
-    n->num_hunks += 1;
-    if (n->num_hunks > n->max_hunks)
-        n->max_hunks = n->num_hunks;
-    n->num_lines = 0;
-    return 0;
-}
-
-/**
- * Callback per text diff line
+ * Data structure to hold the callback information when generating
+ * diff objects.
  *
- * @param delta A pointer to the delta data for the file
- * @param hunk A pointer to the structure describing a hunk of a diff
- * @param line A pointer to the structure describing a line (or data
- * span) of a diff.
- * @param payload A pointer to the git2r_diff_count_payload data structure
- * @return 0
+ * The hunks of the current file are kept in 'hunk_tmp', which grows
+ * as needed, and the lines of the current hunk are staged in native
+ * buffers, so the diff is formatted in one walk.
  */
-static int
-git2r_diff_count_line_cb(
-    const git_diff_delta *delta,
-    const git_diff_hunk *hunk,
-    const git_diff_line *line,
-    void *payload)
-{
-    git2r_diff_count_payload *n = payload;
-
-    GIT2R_UNUSED(delta);
-    GIT2R_UNUSED(hunk);
-    GIT2R_UNUSED(line);
-
-    n->num_lines += 1;
-    if (n->num_lines > n->max_lines)
-        n->max_lines = n->num_lines;
-    return 0;
-}
-
+typedef struct {
+    SEXP result;
+    SEXP hunk_tmp;
+    PROTECT_INDEX hunk_tmp_index;
+    size_t hunk_tmp_size;
+    git2r_diff_line_stage *lines;
+    size_t lines_size;
+    char *content;
+    size_t content_len, content_size;
+    size_t file_ptr, hunk_ptr, line_ptr;
+} git2r_diff_payload;
 
 /**
- *  Count diff objects
+ * Grow a buffer to hold at least n elements
  *
- * @param diff Pointer to the diff
- * @param num_files Pointer where to save the number of files
- * @param max_hunks Pointer where to save the maximum number of hunks
- * @param max_lines Pointer where to save the maximum number of lines
- * @return 0 if OK, else -1
+ * @param buf Pointer to the buffer
+ * @param size Pointer to the number of elements in the buffer
+ * @param n The number of elements that are needed
+ * @param elem_size The size of an element
+ * @return 0 if OK, else GIT_ERROR_NOMEMORY
  */
 static int
-git2r_diff_count(
-    git_diff *diff,
-    size_t *num_files,
-    size_t *max_hunks,
-    size_t *max_lines)
+git2r_diff_grow(
+    void **buf,
+    size_t *size,
+    size_t n,
+    size_t elem_size)
 {
-    int error;
-    git2r_diff_count_payload n = { 0, 0, 0 };
-
-    error = git_diff_foreach(
-        diff,
-        git2r_diff_count_file_cb,
-        /* binary_cb */ NULL,
-        git2r_diff_count_hunk_cb,
-        git2r_diff_count_line_cb,
-        /* payload= */ (void*) &n);
-
-    if (error)
-	return -1;
-
-    *num_files = n.num_files;
-    *max_hunks = n.max_hunks;
-    *max_lines = n.max_lines;
+    size_t new_size = *size ? *size : 64;
+    void *p;
+
+    if (n <= *size)
+        return 0;
+    while (new_size < n)
+        new_size *= 2;
+    p = realloc(*buf, new_size * elem_size);
+    if (!p) {
+        giterr_set_oom();
+        return GIT_ERROR_NOMEMORY;
+    }
 
+    *buf = p;
+    *size = new_size;
     return 0;
 }
 
-/**
- * Data structure to hold the callback information when generating
- * diff objects.
- */
-typedef struct {
-    SEXP result;
-    SEXP hunk_tmp;
-    SEXP line_tmp;
-    size_t file_ptr, hunk_ptr, line_ptr;
-} git2r_diff_payload;
-
 static int
 git2r_diff_get_hunk_cb(
     const git_diff_delta *delta,
@@ -1026,13 +1033,14 @@ git2r_diff_get_file_cb(
 /**
  * Process a hunk
  *
- * First we save the previous hunk, if there was one. Then create an
- * empty hunk (i.e. without any lines) and put it in the result.
+ * First we save the previous hunk, if there was one, by creating its
+ * lines from the staged lines. Then create an empty hunk (i.e. without
+ * any lines) and put it in the hunk_tmp temporary storage.
  *
  * @param delta A pointer to the delta data for the file
  * @param hunk A pointer to the structure describing a hunk of a diff
  * @param payload Pointer to a git2r_diff_payload data structure
- * @return 0
+ * @return 0 if OK, else error code
  */
 static int
 git2r_diff_get_hunk_cb(
@@ -1044,8 +1052,8 @@ git2r_diff_get_hunk_cb(
 
     GIT2R_UNUSED(delta);
 
-    /* Save previous hunk's lines in hunk_tmp, from the line_tmp
-       temporary storage. */
+    /* Save previous hunk's lines in hunk_tmp, from the staged
+       lines. */
     if (p->hunk_ptr != 0) {
 	SEXP lines;
 	size_t len=p->line_ptr, i;
@@ -1054,14 +1062,57 @@ git2r_diff_get_hunk_cb(
             VECTOR_ELT(p->hunk_tmp, p->hunk_ptr-1),
             git2r_S3_item__git_diff_hunk__lines,
             lines = Rf_allocVector(VECSXP, p->line_ptr));
-	for (i = 0; i < len; i++)
-	    SET_VECTOR_ELT(lines, i, VECTOR_ELT(p->line_tmp, i));
+	for (i = 0; i < len; i++) {
+            const git2r_diff_line_stage *l = &p->lines[i];
+            SEXP line_obj;
+
+            SET_VECTOR_ELT(
+                lines,
+                i,
+                line_obj = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff_line));
+            Rf_setAttrib(
+                line_obj,
+                R_ClassSymbol,
+                Rf_mkString(git2r_S3_class__git_diff_line));
+
+            SET_VECTOR_ELT(
+                line_obj,
+                git2r_S3_item__git_diff_line__origin,
+                Rf_ScalarInteger(l->origin));
+
+            SET_VECTOR_ELT(
+                line_obj,
+                git2r_S3_item__git_diff_line__old_lineno,
+                Rf_ScalarInteger(l->old_lineno));
+
+            SET_VECTOR_ELT(
+                line_obj,
+                git2r_S3_item__git_diff_line__new_lineno,
+                Rf_ScalarInteger(l->new_lineno));
+
+            SET_VECTOR_ELT(
+                line_obj,
+                git2r_S3_item__git_diff_line__num_lines,
+                Rf_ScalarInteger(l->num_lines));
+
+            SET_VECTOR_ELT(
+                line_obj,
+                git2r_S3_item__git_diff_line__content,
+                Rf_mkString(p->content + l->content));
+        }
     }
 
     /* OK, ready for the next hunk, if any */
     if (hunk) {
 	SEXP hunk_obj;
 
+        if (p->hunk_ptr == p->hunk_tmp_size) {
+            p->hunk_tmp_size = p->hunk_tmp_size ? 2 * p->hunk_tmp_size : 16;
+            REPROTECT(
+                p->hunk_tmp = Rf_xlengthgets(p->hunk_tmp, p->hunk_tmp_size),
+                p->hunk_tmp_index);
+        }
+
         PROTECT(hunk_obj = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff_hunk));
         Rf_setAttrib(
             hunk_obj,
@@ -1097,6 +1148,7 @@ git2r_diff_get_hunk_cb(
         UNPROTECT(1);
 	p->hunk_ptr += 1;
 	p->line_ptr = 0;
+	p->content_len = 0;
     }
 
     return 0;
@@ -1105,15 +1157,15 @@ git2r_diff_get_hunk_cb(
 /**
  * Process a line
  *
- * This is easy, just populate a git_diff_line object and
- * put it in the temporary hunk.
+ * Stage the line in the native buffers of the payload. The R objects
+ * are created when the hunk is complete.
  *
  * @param delta A pointer to the delta data for the file
  * @param hunk A pointer to the structure describing a hunk of a diff
  * @param line A pointer to the structure describing a line (or data
  * span) of a diff.
  * @param payload Pointer to a git2r_diff_payload data structure
- * @return 0
+ * @return 0 if OK, else error code
  */
 static int
 git2r_diff_get_line_cb(
@@ -1122,55 +1174,39 @@ git2r_diff_get_line_cb(
     const git_diff_line *line,
     void *payload)
 {
+    int error;
     git2r_diff_payload *p = (git2r_diff_payload *) payload;
-    static char short_buffer[200];
-    char *buffer = short_buffer;
-    SEXP line_obj;
+    git2r_diff_line_stage *l;
 
     GIT2R_UNUSED(delta);
     GIT2R_UNUSED(hunk);
 
-    PROTECT(line_obj = Rf_mkNamed(VECSXP, git2r_S3_items__git_diff_line));
-    Rf_setAttrib(
-        line_obj,
-        R_ClassSymbol,
-        Rf_mkString(git2r_S3_class__git_diff_line));
-
-    SET_VECTOR_ELT(
-        line_obj,
-        git2r_S3_item__git_diff_line__origin,
-        Rf_ScalarInteger(line->origin));
-
-    SET_VECTOR_ELT(
-        line_obj,
-        git2r_S3_item__git_diff_line__old_lineno,
-        Rf_ScalarInteger(line->old_lineno));
-
-    SET_VECTOR_ELT(
-        line_obj,
-        git2r_S3_item__git_diff_line__new_lineno,
-        Rf_ScalarInteger(line->new_lineno));
-
-    SET_VECTOR_ELT(
-        line_obj,
-        git2r_S3_item__git_diff_line__num_lines,
-        Rf_ScalarInteger(line->num_lines));
-
-    if (line->content_len > sizeof(buffer))
-	buffer = malloc(line->content_len+1);
-    memcpy(buffer, line->content, line->content_len);
-    buffer[line->content_len] = 0;
+    error = git2r_diff_grow(
+        (void**)&p->lines,
+        &p->lines_size,
+        p->line_ptr + 1,
+        sizeof(git2r_diff_line_stage));
+    if (error)
+        return error;
 
-    SET_VECTOR_ELT(
-        line_obj,
-        git2r_S3_item__git_diff_line__content,
-        Rf_mkString(buffer));
+    error = git2r_diff_grow(
+        (void**)&p->content,
+        &p->content_size,
+        p->content_len + line->content_len + 1,
+        sizeof(char));
+    if (error)
+        return error;
 
-    if (buffer != short_buffer)
-	free(buffer);
+    l = &p->lines[p->line_ptr++];
+    l->origin = line->origin;
+    l->old_lineno = line->old_lineno;
+    l->new_lineno = line->new_lineno;
+    l->num_lines = line->num_lines;
+    l->content = p->content_len;
 
-    SET_VECTOR_ELT(p->line_tmp, p->line_ptr++, line_obj);
-    UNPROTECT(1);
+    memcpy(p->content + p->content_len, line->content, line->content_len);
+    p->content_len += line->content_len;
+    p->content[p->content_len++] = '\0';
 
     return 0;
 }
@@ -1178,16 +1214,11 @@ git2r_diff_get_line_cb(
 /**
  * Format a diff as an R object
  *
- * libgit2 has callbacks to walk over the files, hunks and line
- * of a diff. This means that we need to walk over the diff twice,
- * if we don't want to reallocate our lists over and over again (or write a
- * smart list that preallocates memory).
- *
- * So we walk over it first and calculate the maximum number of
- * hunks in a file, and the maximum number of lines in a hunk.
- *
- * Then in the second walk, we have a correspondingly allocated
- * list that we use for temporary storage.
+ * libgit2 has callbacks to walk over the files, hunks and lines of a
+ * diff. The diff is walked once: the number of deltas is an upper
+ * bound on the number of files, the hunks of a file are kept in a
+ * list that grows as needed, and the lines of a hunk are staged in
+ * native buffers until the hunk is complete.
  *
  * @param diff Pointer to the diff
  * @param dest The S3 class git_diff to hold the formated diff
@@ -1198,29 +1229,18 @@ git2r_diff_format_to_r(
     git_diff *diff,
     SEXP dest)
 {
-    int error, nprotect = 0;
-    git2r_diff_payload payload = { /* result=   */ R_NilValue,
-                                   /* hunk_tmp= */ R_NilValue,
-                                   /* line_tmp= */ R_NilValue,
-                                   /* file_ptr= */ 0,
-                                   /* hunk_ptr= */ 0,
-                                   /* line_ptr= */ 0 };
-
-    size_t num_files, max_hunks, max_lines;
-
-    error = git2r_diff_count(diff, &num_files, &max_hunks, &max_lines);
+    int error;
+    git2r_diff_payload payload;
 
-    if (error)
-        return error;
+    memset(&payload, 0, sizeof(payload));
 
     SET_VECTOR_ELT(
         dest,
         git2r_S3_item__git_diff__files,
-        payload.result = Rf_allocVector(VECSXP, num_files));
-    PROTECT(payload.hunk_tmp = Rf_allocVector(VECSXP, max_hunks));
-    nprotect++;
-    PROTECT(payload.line_tmp = Rf_allocVector(VECSXP, max_lines));
-    nprotect++;
+        payload.result = Rf_allocVector(VECSXP, git_diff_num_deltas(diff)));
+    PROTECT_WITH_INDEX(
+        payload.hunk_tmp = Rf_allocVector(VECSXP, 0),
+        &payload.hunk_tmp_index);
 
     error = git_diff_foreach(
         diff,
@@ -1237,8 +1257,320 @@ git2r_diff_format_to_r(
             &payload);
     }
 
-    if (nprotect)
-        UNPROTECT(nprotect);
+    /* Deltas that are skipped by the walk have no file. */
+    if (!error && payload.file_ptr < (size_t)XLENGTH(payload.result)) {
+        SET_VECTOR_ELT(
+            dest,
+            git2r_S3_item__git_diff__files,
+            Rf_xlengthgets(payload.result, payload.file_ptr));
+    }
+
+    free(payload.lines);
+    free(payload.content);
+    UNPROTECT(1);
+
+    return error;
+}
+
+/**
+ * Get the name of the status of a delta
+ *
+ * @param status The status of the delta
+ * @return The name of the status
+ */
+const char*
+git2r_diff_status_name(
+    git_delta_t status)
+{
+    switch (status) {
+    case GIT_DELTA_UNMODIFIED:
+        return "unmodified";
+    case GIT_DELTA_ADDED:
+        return "added";
+    case GIT_DELTA_DELETED:
+        return "deleted";
+    case GIT_DELTA_MODIFIED:
+        return "modified";
+    case GIT_DELTA_RENAMED:
+        return "renamed";
+    case GIT_DELTA_COPIED:
+        return "copied";
+    case GIT_DELTA_IGNORED:
+        return "ignored";
+    case GIT_DELTA_UNTRACKED:
+        return "untracked";
+    case GIT_DELTA_TYPECHANGE:
+        return "typechange";
+    case GIT_DELTA_UNREADABLE:
+        return "unreadable";
+    case GIT_DELTA_CONFLICTED:
+        return "conflicted";
+    }
+
+    return "unknown";
+}
+
+/**
+ * Get the line statistics per file of a diff
+ *
+ * The patch of every delta is generated in native memory to count
+ * the added and deleted lines, but no R objects are created for the
+ * hunks and lines.
+ *
+ * @param diff Pointer to the diff
+ * @param out The list with the columns path, status, additions,
+ * deletions and binary. The list is not protected.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_diff_stats_to_r(
+    git_diff *diff,
+    SEXP *out)
+{
+    const char *names[] = {"path", "status", "additions", "deletions",
+                           "binary", ""};
+    int error = GIT_OK;
+    size_t i, j = 0, n = git_diff_num_deltas(diff);
+    SEXP result;
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(INTSXP, n));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(INTSXP, n));
+    SET_VECTOR_ELT(result, 4, Rf_allocVector(LGLSXP, n));
+
+    for (i = 0; i < n; i++) {
+        const git_diff_delta *delta;
+        git_patch *patch = NULL;
+        size_t additions = 0, deletions = 0;
+        int binary;
+
+        error = git_patch_from_diff(&patch, diff, i);
+        if (error)
+            break;
+
+        /* Skip the deltas that are not part of the diff output,
+         * e.g. unmodified files. */
+        if (!patch)
+            continue;
+
+        error = git_patch_line_stats(NULL, &additions, &deletions, patch);
+        binary = (git_patch_get_delta(patch)->flags & GIT_DIFF_FLAG_BINARY) != 0;
+        git_patch_free(patch);
+        if (error)
+            break;
+
+        delta = git_diff_get_delta(diff, i);
+        SET_STRING_ELT(
+            VECTOR_ELT(result, 0), j,
+            Rf_mkChar(delta->new_file.path));
+        SET_STRING_ELT(
+            VECTOR_ELT(result, 1), j,
+            Rf_mkChar(git2r_diff_status_name(delta->status)));
+        INTEGER(VECTOR_ELT(result, 2))[j] = (int)additions;
+        INTEGER(VECTOR_ELT(result, 3))[j] = (int)deletions;
+        LOGICAL(VECTOR_ELT(result, 4))[j] = binary;
+        j++;
+    }
+
+    if (!error && j < n) {
+        for (i = 0; i < 5; i++)
+            SET_VECTOR_ELT(result, i, Rf_xlengthgets(VECTOR_ELT(result, i), j));
+    }
+
+    UNPROTECT(1);
+    *out = result;
+
+    return error;
+}
+
+/**
+ * Data structure to hold the callback information when generating
+ * the table of diff lines. The columns are kept in 'result' and grow
+ * as needed.
+ */
+typedef struct {
+    SEXP result;
+    SEXP path;
+    R_xlen_t size, n;
+    int file, hunk;
+} git2r_diff_table_payload;
+
+/**
+ * Callback per file when generating the table of diff lines
+ *
+ * @param delta A pointer to the delta data for the file
+ * @param progress Goes from 0 to 1 over the diff
+ * @param payload A pointer to the git2r_diff_table_payload data structure
+ * @return 0
+ */
+static int
+git2r_diff_table_file_cb(
+    const git_diff_delta *delta,
+    float progress,
+    void *payload)
+{
+    git2r_diff_table_payload *p = payload;
+
+    GIT2R_UNUSED(progress);
+
+    SET_STRING_ELT(p->path, 0, Rf_mkChar(delta->new_file.path));
+    p->file++;
+    p->hunk = 0;
+
+    return 0;
+}
+
+/**
+ * Callback per hunk when generating the table of diff lines
+ *
+ * @param delta A pointer to the delta data for the file
+ * @param hunk A pointer to the structure describing a hunk of a diff
+ * @param payload A pointer to the git2r_diff_table_payload data structure
+ * @return 0
+ */
+static int
+git2r_diff_table_hunk_cb(
+    const git_diff_delta *delta,
+    const git_diff_hunk *hunk,
+    void *payload)
+{
+    git2r_diff_table_payload *p = payload;
+
+    GIT2R_UNUSED(delta);
+    GIT2R_UNUSED(hunk);
+
+    p->hunk++;
+
+    return 0;
+}
+
+/**
+ * Callback per line when generating the table of diff lines
+ *
+ * @param delta A pointer to the delta data for the file
+ * @param hunk A pointer to the structure describing a hunk of a diff
+ * @param line A pointer to the structure describing a line (or data
+ * span) of a diff.
+ * @param payload A pointer to the git2r_diff_table_payload data structure
+ * @return 0
+ */
+static int
+git2r_diff_table_line_cb(
+    const git_diff_delta *delta,
+    const git_diff_hunk *hunk,
+    const git_diff_line *line,
+    void *payload)
+{
+    git2r_diff_table_payload *p = payload;
+    const char *nul;
+    size_t len;
+    int i;
+
+    GIT2R_UNUSED(delta);
+    GIT2R_UNUSED(hunk);
+
+    if (p->n == p->size) {
+        p->size *= 2;
+        for (i = 0; i < 8; i++) {
+            SET_VECTOR_ELT(
+                p->result, i,
+                Rf_xlengthgets(VECTOR_ELT(p->result, i), p->size));
+        }
+    }
+
+    /* The content ends at the first NUL, as in the git_diff_line
+     * object. */
+    nul = memchr(line->content, '\0', line->content_len);
+    len = nul ? (size_t)(nul - line->content) : line->content_len;
+
+    INTEGER(VECTOR_ELT(p->result, 0))[p->n] = p->file;
+    SET_STRING_ELT(VECTOR_ELT(p->result, 1), p->n, STRING_ELT(p->path, 0));
+    INTEGER(VECTOR_ELT(p->result, 2))[p->n] = p->hunk;
+    INTEGER(VECTOR_ELT(p->result, 3))[p->n] = line->origin;
+    INTEGER(VECTOR_ELT(p->result, 4))[p->n] = line->old_lineno;
+    INTEGER(VECTOR_ELT(p->result, 5))[p->n] = line->new_lineno;
+    INTEGER(VECTOR_ELT(p->result, 6))[p->n] = line->num_lines;
+    SET_STRING_ELT(
+        VECTOR_ELT(p->result, 7), p->n,
+        Rf_mkCharLen(line->content, (int)len));
+    p->n++;
+
+    return 0;
+}
+
+/**
+ * Get the lines of a diff as the columns of a table
+ *
+ * The columns are allocated up front and filled directly from the
+ * diff callbacks; they are doubled when they are full and
+ * shortened to the number of lines at the end.
+ *
+ * @param diff Pointer to the diff
+ * @param out The list with the columns file, path, hunk, origin,
+ * old_lineno, new_lineno, num_lines and content. The list is not
+ * protected.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_diff_table_to_r(
+    git_diff *diff,
+    SEXP *out)
+{
+    const char *names[] = {"file", "path", "hunk", "origin", "old_lineno",
+                           "new_lineno", "num_lines", "content", ""};
+    int i, error;
+    git2r_diff_table_payload payload;
+
+    memset(&payload, 0, sizeof(payload));
+    payload.size = 1024;
+
+    PROTECT(payload.result = Rf_mkNamed(VECSXP, names));
+    PROTECT(payload.path = Rf_allocVector(STRSXP, 1));
+    for (i = 0; i < 8; i++) {
+        SET_VECTOR_ELT(
+            payload.result, i,
+            Rf_allocVector(i == 1 || i == 7 ? STRSXP : INTSXP, payload.size));
+    }
+
+    error = git_diff_foreach(
+        diff,
+        git2r_diff_table_file_cb,
+        /* binary_cb */ NULL,
+        git2r_diff_table_hunk_cb,
+        git2r_diff_table_line_cb,
+        &payload);
+
+    if (!error) {
+        for (i = 0; i < 8; i++) {
+            SET_VECTOR_ELT(
+                payload.result, i,
+                Rf_xlengthgets(VECTOR_ELT(payload.result, i), payload.n));
+        }
+    }
+
+    UNPROTECT(2);
+    *out = payload.result;
 
     return error;
 }
+
+/**
+ * Format a diff as a list of columns
+ *
+ * @param diff Pointer to the diff
+ * @param format GIT2R_DIFF_FORMAT_STATS or GIT2R_DIFF_FORMAT_TABLE
+ * @param out The list with the columns. The list is not protected.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_diff_columns_to_r(
+    git_diff *diff,
+    int format,
+    SEXP *out)
+{
+    if (format == GIT2R_DIFF_FORMAT_TABLE)
+        return git2r_diff_table_to_r(diff, out);
+    return git2r_diff_stats_to_r(diff, out);
+}
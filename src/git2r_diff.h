@@ -19,6 +19,11 @@
 #ifndef INCLUDE_git2r_diff_h
 #define INCLUDE_git2r_diff_h
 
+#include <R.h>
+#include <Rinternals.h>
+#include <git2.h>
+
+const char* git2r_diff_status_name(git_delta_t status);
 SEXP git2r_diff(
     SEXP repo,
     SEXP tree1,
@@ -31,6 +36,7 @@ SEXP git2r_diff(
     SEXP new_prefix,
     SEXP id_abbrev,
     SEXP path,
-    SEXP max_size);
+    SEXP max_size,
+    SEXP format);
 
 #endif
@@ -25,9 +25,13 @@
  */
 
 const char git2r_err_alloc_memory_buffer[] = "Unable to allocate memory buffer";
+const char git2r_err_blob_nul[] =
+    "The lines contain a NUL byte, read the bytes with 'blob_reader_read'";
 const char git2r_err_branch_not_local[] = "'branch' is not local";
 const char git2r_err_branch_not_remote[] = "'branch' is not remote";
+const char git2r_err_changed_paths_write[] = "Unable to write the changed-path index";
 const char git2r_err_checkout_tree[] = "Expected commit, tag or tree";
+const char git2r_err_hash_size[] = "The length of the data differs from 'size'";
 const char git2r_err_invalid_refname[] = "Invalid reference name";
 const char git2r_err_invalid_remote[] = "Invalid remote name";
 const char git2r_err_invalid_repository[] = "Invalid repository";
@@ -48,6 +52,8 @@ const char git2r_err_unable_to_set_proxy_options[] = "Unable to set proxy option
  */
 const char git2r_err_blob_arg[] =
     "must be an S3 class git_blob";
+const char git2r_err_blob_reader_arg[] =
+    "must be an open S3 class git_blob_reader";
 const char git2r_err_branch_arg[] =
     "must be an S3 class git_branch";
 const char git2r_err_commit_arg[] =
@@ -66,16 +72,24 @@ const char git2r_err_filename_arg[] =
     "must be either 1) NULL, or 2) a character vector of length 0 or 3) a character vector of length 1 and nchar > 0";
 const char git2r_err_sha_arg[] =
     "must be a sha value";
+const char git2r_err_hash_context_arg[] =
+    "must be a hash context";
 const char git2r_err_integer_arg[] =
     "must be an integer vector of length one with non NA value";
+const char git2r_err_number_gte_zero_arg[] =
+    "must be a numeric vector of length one with value greater than or equal to zero";
 const char git2r_err_integer_gte_zero_arg[] =
     "must be an integer vector of length one with value greater than or equal to zero";
 const char git2r_err_list_arg[] =
     "must be a list";
+const char git2r_err_raw_list_arg[] =
+    "must be a list of raw vectors";
 const char git2r_err_logical_arg[] =
     "must be logical vector of length one with non NA value";
 const char git2r_err_note_arg[] =
     "must be an S3 class git_note";
+const char git2r_err_oid_vector_arg[] =
+    "must be an S3 class git_oid_vector";
 const char git2r_err_signature_arg[] =
     "must be an S3 class git_signature";
 const char git2r_err_string_arg[] =
@@ -25,9 +25,12 @@
  * Error messages
  */
 extern const char git2r_err_alloc_memory_buffer[];
+extern const char git2r_err_blob_nul[];
 extern const char git2r_err_branch_not_local[];
 extern const char git2r_err_branch_not_remote[];
+extern const char git2r_err_changed_paths_write[];
 extern const char git2r_err_checkout_tree[];
+extern const char git2r_err_hash_size[];
 extern const char git2r_err_invalid_refname[];
 extern const char git2r_err_invalid_remote[];
 extern const char git2r_err_invalid_repository[];
@@ -46,6 +49,7 @@ extern const char git2r_err_unable_to_set_proxy_options[];
  * Error messages specific to argument checking
  */
 extern const char git2r_err_blob_arg[];
+extern const char git2r_err_blob_reader_arg[];
 extern const char git2r_err_branch_arg[];
 extern const char git2r_err_commit_arg[];
 extern const char git2r_err_commit_stash_arg[];
@@ -55,11 +59,15 @@ extern const char git2r_err_diff_arg[];
 extern const char git2r_err_fetch_heads_arg[];
 extern const char git2r_err_filename_arg[];
 extern const char git2r_err_sha_arg[];
+extern const char git2r_err_hash_context_arg[];
 extern const char git2r_err_integer_arg[];
+extern const char git2r_err_number_gte_zero_arg[];
 extern const char git2r_err_integer_gte_zero_arg[];
 extern const char git2r_err_list_arg[];
+extern const char git2r_err_raw_list_arg[];
 extern const char git2r_err_logical_arg[];
 extern const char git2r_err_note_arg[];
+extern const char git2r_err_oid_vector_arg[];
 extern const char git2r_err_signature_arg[];
 extern const char git2r_err_string_arg[];
 extern const char git2r_err_string_vec_arg[];
@@ -18,6 +18,9 @@
 
 #include <R_ext/Visibility.h>
 #include <git2.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
@@ -77,7 +80,505 @@ git2r_graph_ahead_behind(
     INTEGER(result)[1] = (int)behind;
 
 cleanup:
-    git_repository_free(repository);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
+
+#define GIT2R_GRAPH_NODE_NEW    0
+#define GIT2R_GRAPH_NODE_QUEUED 1
+#define GIT2R_GRAPH_NODE_DONE   2
+
+/**
+ * A commit in the walk of git2r_graph_ahead_behind_group.
+ */
+typedef struct {
+    git_oid oid;
+    git_time_t time;
+    int state;
+} git2r_graph_node;
+
+/**
+ * Walk from an upstream commit and many local commits at once. Every
+ * commit has a bit array with the tips that reach it, where bit 0 is
+ * the upstream and bit 1 to n_bits - 1 are the local commits. The
+ * commits are visited newest first, and the walk stops when every
+ * queued commit is reached from all tips, since such a commit and
+ * its ancestors are neither ahead nor behind for any pair.
+ */
+typedef struct {
+    git2r_graph_node *nodes;
+    uint64_t *bits;
+    size_t n_bits;
+    size_t words;
+    size_t n;
+    size_t size;
+    size_t *slots; /* One-based index, or 0 for an empty slot. */
+    size_t mask;
+    size_t *heap;
+    size_t n_heap;
+    size_t n_partial; /* Queued commits not reached from all tips. */
+} git2r_graph_walk;
+
+static void
+git2r_graph_walk_free(
+    git2r_graph_walk *walk)
+{
+    free(walk->nodes);
+    free(walk->bits);
+    free(walk->slots);
+    free(walk->heap);
+    memset(walk, 0, sizeof(git2r_graph_walk));
+}
+
+static int
+git2r_graph_walk_full(
+    const git2r_graph_walk *walk,
+    size_t i)
+{
+    size_t j, rest = walk->n_bits % 64;
+    const uint64_t *bits = walk->bits + i * walk->words;
+
+    for (j = 0; j < walk->n_bits / 64; j++) {
+        if (bits[j] != UINT64_MAX)
+            return 0;
+    }
+
+    return !rest || bits[j] == (((uint64_t)1 << rest) - 1);
+}
+
+static size_t
+git2r_graph_walk_slot(
+    const git2r_graph_walk *walk,
+    const git_oid *oid)
+{
+    size_t slot;
+
+    /* The oids are uniformly distributed, so the first bytes of the
+     * oid are used as the hash. */
+    memcpy(&slot, oid->id, sizeof(size_t));
+    slot &= walk->mask;
+    while (walk->slots[slot] &&
+           !git_oid_equal(&walk->nodes[walk->slots[slot] - 1].oid, oid)) {
+        slot = (slot + 1) & walk->mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Find a commit in the walk, or add it with no bits set.
+ *
+ * @param out The index of the commit.
+ * @param walk The walk.
+ * @param repository The repository with the commit.
+ * @param oid The id of the commit.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_graph_walk_node(
+    size_t *out,
+    git2r_graph_walk *walk,
+    git_repository *repository,
+    const git_oid *oid)
+{
+    int error;
+    size_t i, slot;
+    git_commit *commit = NULL;
+
+    if (2 * (walk->n + 1) > walk->mask + 1) {
+        size_t size = walk->slots ? 2 * (walk->mask + 1) : 1024;
+        size_t *slots = calloc(size, sizeof(size_t));
+
+        if (!slots)
+            goto oom;
+        free(walk->slots);
+        walk->slots = slots;
+        walk->mask = size - 1;
+        for (i = 0; i < walk->n; i++)
+            walk->slots[git2r_graph_walk_slot(walk, &walk->nodes[i].oid)] = i + 1;
+    }
+
+    slot = git2r_graph_walk_slot(walk, oid);
+    if (walk->slots[slot]) {
+        *out = walk->slots[slot] - 1;
+        return 0;
+    }
+
+    if (walk->n == walk->size) {
+        size_t size = walk->size ? 2 * walk->size : 512;
+        void *nodes, *bits, *heap;
+
+        nodes = realloc(walk->nodes, size * sizeof(git2r_graph_node));
+        if (!nodes)
+            goto oom;
+        walk->nodes = nodes;
+        bits = realloc(walk->bits, size * walk->words * sizeof(uint64_t));
+        if (!bits)
+            goto oom;
+        walk->bits = bits;
+        heap = realloc(walk->heap, size * sizeof(size_t));
+        if (!heap)
+            goto oom;
+        walk->heap = heap;
+        walk->size = size;
+    }
+
+    error = git_commit_lookup(&commit, repository, oid);
+    if (error)
+        return error;
+
+    i = walk->n++;
+    git_oid_cpy(&walk->nodes[i].oid, oid);
+    walk->nodes[i].time = git_commit_time(commit);
+    walk->nodes[i].state = GIT2R_GRAPH_NODE_NEW;
+    memset(walk->bits + i * walk->words, 0, walk->words * sizeof(uint64_t));
+    walk->slots[slot] = i + 1;
+    git_commit_free(commit);
+    *out = i;
+
+    return 0;
+
+oom:
+    giterr_set_oom();
+    return GIT_ERROR_NOMEMORY;
+}
+
+static int
+git2r_graph_walk_newer(
+    const git2r_graph_walk *walk,
+    size_t a,
+    size_t b)
+{
+    return walk->nodes[walk->heap[a]].time > walk->nodes[walk->heap[b]].time;
+}
+
+static void
+git2r_graph_walk_swap(
+    git2r_graph_walk *walk,
+    size_t a,
+    size_t b)
+{
+    size_t tmp = walk->heap[a];
+    walk->heap[a] = walk->heap[b];
+    walk->heap[b] = tmp;
+}
+
+/**
+ * Add bits to a commit and queue it if it is new, or if it gains
+ * bits after it has been visited, so that the bits are propagated to
+ * its parents again.
+ *
+ * @param walk The walk.
+ * @param i The index of the commit.
+ * @param bits The bits to add, or NULL to add the bit 'bit'.
+ * @param bit The bit to add when bits is NULL.
+ */
+static void
+git2r_graph_walk_mark(
+    git2r_graph_walk *walk,
+    size_t i,
+    const uint64_t *bits,
+    size_t bit)
+{
+    size_t k;
+    uint64_t changed = 0;
+    int was_full = git2r_graph_walk_full(walk, i);
+    uint64_t *dst = walk->bits + i * walk->words;
+
+    if (bits) {
+        for (k = 0; k < walk->words; k++) {
+            changed |= bits[k] & ~dst[k];
+            dst[k] |= bits[k];
+        }
+    } else {
+        changed = !(dst[bit / 64] & ((uint64_t)1 << (bit % 64)));
+        dst[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+
+    if (walk->nodes[i].state == GIT2R_GRAPH_NODE_QUEUED) {
+        if (!was_full && git2r_graph_walk_full(walk, i))
+            walk->n_partial--;
+        return;
+    }
+    if (walk->nodes[i].state == GIT2R_GRAPH_NODE_DONE && !changed)
+        return;
+
+    walk->nodes[i].state = GIT2R_GRAPH_NODE_QUEUED;
+    if (!git2r_graph_walk_full(walk, i))
+        walk->n_partial++;
+
+    k = walk->n_heap++;
+    walk->heap[k] = i;
+    while (k && git2r_graph_walk_newer(walk, k, (k - 1) / 2)) {
+        git2r_graph_walk_swap(walk, k, (k - 1) / 2);
+        k = (k - 1) / 2;
+    }
+}
+
+static size_t
+git2r_graph_walk_pop(
+    git2r_graph_walk *walk)
+{
+    size_t k = 0, i = walk->heap[0];
+
+    walk->heap[0] = walk->heap[--walk->n_heap];
+    for (;;) {
+        size_t l = 2 * k + 1, r = l + 1, newest = k;
+
+        if (l < walk->n_heap && git2r_graph_walk_newer(walk, l, newest))
+            newest = l;
+        if (r < walk->n_heap && git2r_graph_walk_newer(walk, r, newest))
+            newest = r;
+        if (newest == k)
+            break;
+        git2r_graph_walk_swap(walk, k, newest);
+        k = newest;
+    }
+
+    walk->nodes[i].state = GIT2R_GRAPH_NODE_DONE;
+    if (!git2r_graph_walk_full(walk, i))
+        walk->n_partial--;
+
+    return i;
+}
+
+/**
+ * Count the commits that each local commit is ahead and behind an
+ * upstream commit, with one walk for all local commits.
+ *
+ * The walk continues while a queued commit is not reached from all
+ * tips, or is as new as a visited commit that is not reached from
+ * all tips, since commits with the same time are not visited in
+ * topological order. The commits are counted from their bits when
+ * the walk is done.
+ * @param ahead The number of commits ahead for each local commit.
+ * @param behind The number of commits behind for each local commit.
+ * @param repository The repository.
+ * @param upstream The upstream commit.
+ * @param local The local commits.
+ * @param n_local The number of local commits.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_graph_ahead_behind_group(
+    size_t *ahead,
+    size_t *behind,
+    git_repository *repository,
+    const git_oid *upstream,
+    const git_oid **local,
+    size_t n_local)
+{
+    int error = 0, partial_done = 0;
+    size_t i, j;
+    git_time_t partial_time = 0;
+    git2r_graph_walk walk;
+
+    memset(&walk, 0, sizeof(walk));
+    walk.n_bits = n_local + 1;
+    walk.words = (walk.n_bits + 63) / 64;
+
+    for (j = 0; j <= n_local; j++) {
+        error = git2r_graph_walk_node(
+            &i, &walk, repository, j ? local[j - 1] : upstream);
+        if (error)
+            goto cleanup;
+        git2r_graph_walk_mark(&walk, i, NULL, j);
+    }
+
+    while (walk.n_heap &&
+           (walk.n_partial ||
+            (partial_done && walk.nodes[walk.heap[0]].time >= partial_time))) {
+        git_commit *commit = NULL;
+        unsigned int p, n_parents;
+
+        i = git2r_graph_walk_pop(&walk);
+        if (!git2r_graph_walk_full(&walk, i) &&
+            (!partial_done || walk.nodes[i].time < partial_time)) {
+            partial_done = 1;
+            partial_time = walk.nodes[i].time;
+        }
+
+        error = git_commit_lookup(&commit, repository, &walk.nodes[i].oid);
+        if (error)
+            goto cleanup;
+
+        n_parents = git_commit_parentcount(commit);
+        for (p = 0; p < n_parents; p++) {
+            size_t parent;
+
+            error = git2r_graph_walk_node(
+                &parent, &walk, repository, git_commit_parent_id(commit, p));
+            if (error)
+                break;
+
+            /* The bits may have moved when the parent was added. */
+            git2r_graph_walk_mark(
+                &walk, parent, walk.bits + i * walk.words, 0);
+        }
+
+        git_commit_free(commit);
+        if (error)
+            goto cleanup;
+    }
+
+    /* The commits that are not visited are reached from all tips,
+     * and are neither ahead nor behind. */
+    for (i = 0; i < walk.n; i++) {
+        const uint64_t *bits = walk.bits + i * walk.words;
+        int from_upstream = (int)(bits[0] & 1);
+
+        for (j = 1; j <= n_local; j++) {
+            int from_local = (int)((bits[j / 64] >> (j % 64)) & 1);
+
+            if (from_local && !from_upstream)
+                ahead[j - 1]++;
+            else if (from_upstream && !from_local)
+                behind[j - 1]++;
+        }
+    }
+
+cleanup:
+    git2r_graph_walk_free(&walk);
+
+    return error;
+}
+
+/**
+ * The oids of the pairs to sort by upstream and then by local.
+ */
+static const git_oid *git2r_graph_sort_local;
+static const git_oid *git2r_graph_sort_upstream;
+
+static int
+git2r_graph_pair_cmp(
+    const void *a,
+    const void *b)
+{
+    size_t i = *(const size_t*)a, j = *(const size_t*)b;
+    int cmp = git_oid_cmp(&git2r_graph_sort_upstream[i],
+                          &git2r_graph_sort_upstream[j]);
+
+    if (cmp)
+        return cmp;
+    return git_oid_cmp(&git2r_graph_sort_local[i], &git2r_graph_sort_local[j]);
+}
+
+/**
+ * Count the number of unique commits between many pairs of commits
+ *
+ * The pairs are grouped by upstream commit, and the commits in a
+ * group are counted with one walk for all local commits in the group.
+ * @param repo S3 class git_repository
+ * @param local The local commits as a git_oid_vector
+ * @param upstream The upstream commits as a git_oid_vector with the
+ * same length as local.
+ * @return Integer matrix with one row per pair and the columns ahead
+ * and behind. A pair with a missing commit is NA.
+ */
+SEXP attribute_hidden
+git2r_graph_ahead_behind_table(
+    SEXP repo,
+    SEXP local,
+    SEXP upstream)
+{
+    int error = 0, nprotect = 0;
+    SEXP result = R_NilValue;
+    size_t i, j, start, n, n_pairs = 0;
+    size_t *pairs = NULL, *ahead = NULL, *behind = NULL;
+    git_oid *local_oids = NULL, *upstream_oids = NULL;
+    const git_oid **tips = NULL;
+    git_repository *repository = NULL;
+
+    if (git2r_arg_check_oid_vector(local))
+        git2r_error(__func__, NULL, "'local'", git2r_err_oid_vector_arg);
+    if (git2r_arg_check_oid_vector(upstream))
+        git2r_error(__func__, NULL, "'upstream'", git2r_err_oid_vector_arg);
+    n = (size_t)(Rf_xlength(local) / GIT_OID_RAWSZ);
+    if ((size_t)(Rf_xlength(upstream) / GIT_OID_RAWSZ) != n)
+        git2r_error(__func__, NULL, "'local' and 'upstream' must have the same length", NULL);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    PROTECT(result = Rf_allocMatrix(INTSXP, (int)n, 2));
+    nprotect++;
+    if (!n)
+        goto cleanup;
+
+    pairs = malloc(n * sizeof(size_t));
+    ahead = calloc(n, sizeof(size_t));
+    behind = calloc(n, sizeof(size_t));
+    local_oids = malloc(n * sizeof(git_oid));
+    upstream_oids = malloc(n * sizeof(git_oid));
+    tips = malloc(n * sizeof(git_oid*));
+    if (!pairs || !ahead || !behind || !local_oids || !upstream_oids || !tips) {
+        giterr_set_oom();
+        error = GIT_ERROR_NOMEMORY;
+        goto cleanup;
+    }
+
+    /* The zero oid of a missing commit gives NA. */
+    for (i = 0; i < n; i++) {
+        git2r_oid_vector_get(local, (R_xlen_t)i, &local_oids[i]);
+        git2r_oid_vector_get(upstream, (R_xlen_t)i, &upstream_oids[i]);
+        if (git_oid_is_zero(&local_oids[i]) || git_oid_is_zero(&upstream_oids[i])) {
+            INTEGER(result)[i] = NA_INTEGER;
+            INTEGER(result)[n + i] = NA_INTEGER;
+        } else {
+            pairs[n_pairs++] = i;
+        }
+    }
+
+    git2r_graph_sort_local = local_oids;
+    git2r_graph_sort_upstream = upstream_oids;
+    qsort(pairs, n_pairs, sizeof(size_t), git2r_graph_pair_cmp);
+
+    for (start = 0; start < n_pairs; start = i) {
+        const git_oid *oid = &upstream_oids[pairs[start]];
+        size_t n_tips = 0;
+
+        /* The pairs of a group are sorted by local, so equal local
+         * commits are adjacent and walked from once. */
+        for (i = start; i < n_pairs; i++) {
+            const git_oid *tip = &local_oids[pairs[i]];
+
+            if (!git_oid_equal(&upstream_oids[pairs[i]], oid))
+                break;
+            if (!n_tips || !git_oid_equal(tips[n_tips - 1], tip))
+                tips[n_tips++] = tip;
+        }
+
+        memset(ahead, 0, n_tips * sizeof(size_t));
+        memset(behind, 0, n_tips * sizeof(size_t));
+        error = git2r_graph_ahead_behind_group(
+            ahead, behind, repository, oid, tips, n_tips);
+        if (error)
+            goto cleanup;
+
+        for (j = start, n_tips = 0; j < i; j++) {
+            if (!git_oid_equal(tips[n_tips], &local_oids[pairs[j]]))
+                n_tips++;
+            INTEGER(result)[pairs[j]] = (int)ahead[n_tips];
+            INTEGER(result)[n + pairs[j]] = (int)behind[n_tips];
+        }
+    }
+
+cleanup:
+    free(pairs);
+    free(ahead);
+    free(behind);
+    free(local_oids);
+    free(upstream_oids);
+    free(tips);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -133,7 +634,7 @@ git2r_graph_descendant_of(
     error = 0;
 
 cleanup:
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
@@ -23,6 +23,7 @@
 #include <Rinternals.h>
 
 SEXP git2r_graph_ahead_behind(SEXP local, SEXP upstream);
+SEXP git2r_graph_ahead_behind_table(SEXP repo, SEXP local, SEXP upstream);
 SEXP git2r_graph_descendant_of(SEXP commit, SEXP ancestor);
 
 #endif
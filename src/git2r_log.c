@@ -0,0 +1,1022 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2026 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <R_ext/Visibility.h>
+#include <git2.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "git2r_arg.h"
+#include "git2r_diff.h"
+#include "git2r_error.h"
+#include "git2r_log.h"
+#include "git2r_oid.h"
+#include "git2r_repository.h"
+
+/**
+ * The value of 'all_parents' to skip the merge commits.
+ */
+#define GIT2R_LOG_NO_MERGES -1
+
+/**
+ * The diff statistics of a file in a commit.
+ */
+typedef struct {
+    unsigned int parent;
+    git_delta_t status;
+    char *path;
+    size_t additions;
+    size_t deletions;
+} git2r_log_stats_row;
+
+/**
+ * The diff statistics of a commit against its parents. The rows are
+ * written by the thread that diffs the commit, and read by the main
+ * thread when all commits are done.
+ */
+typedef struct {
+    git2r_log_stats_row *rows;
+    size_t n;
+    size_t size;
+    git_oid *parents;
+    unsigned int n_parents;
+    char *author;
+    git_time_t when;
+    char *error;
+} git2r_log_stats_commit;
+
+static void
+git2r_log_stats_commit_free(
+    git2r_log_stats_commit *commit)
+{
+    size_t i;
+
+    for (i = 0; i < commit->n; i++)
+        free(commit->rows[i].path);
+    free(commit->rows);
+    free(commit->parents);
+    free(commit->author);
+    free(commit->error);
+    memset(commit, 0, sizeof(git2r_log_stats_commit));
+}
+
+/**
+ * Append the statistics of the deltas in a diff to a commit.
+ *
+ * @param out The commit to append the rows to
+ * @param diff The diff between the commit and a parent
+ * @param parent The index of the parent
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_stats_append(
+    git2r_log_stats_commit *out,
+    git_diff *diff,
+    unsigned int parent)
+{
+    size_t i, n = git_diff_num_deltas(diff);
+
+    for (i = 0; i < n; i++) {
+        int error;
+        git_patch *patch = NULL;
+        const git_diff_delta *delta;
+        git2r_log_stats_row *row;
+
+        error = git_patch_from_diff(&patch, diff, i);
+        if (error)
+            return error;
+        if (!patch)
+            continue;
+
+        if (out->n == out->size) {
+            size_t size = out->size ? 2 * out->size : 16;
+            void *p = realloc(out->rows, size * sizeof(git2r_log_stats_row));
+            if (!p) {
+                git_patch_free(patch);
+                giterr_set_oom();
+                return GIT_ERROR_NOMEMORY;
+            }
+            out->rows = p;
+            out->size = size;
+        }
+
+        row = &out->rows[out->n];
+        memset(row, 0, sizeof(git2r_log_stats_row));
+        error = git_patch_line_stats(
+            NULL, &row->additions, &row->deletions, patch);
+        git_patch_free(patch);
+        if (error)
+            return error;
+
+        delta = git_diff_get_delta(diff, i);
+        row->parent = parent;
+        row->status = delta->status;
+        row->path = malloc(strlen(delta->new_file.path) + 1);
+        if (!row->path) {
+            giterr_set_oom();
+            return GIT_ERROR_NOMEMORY;
+        }
+        strcpy(row->path, delta->new_file.path);
+        out->n++;
+    }
+
+    return 0;
+}
+
+/**
+ * Diff a commit against its first parent, or all parents, and
+ * collect the line statistics per file. A root commit is diffed
+ * against the empty tree.
+ *
+ * @param out The commit to write the statistics to
+ * @param repository The repository with the commit
+ * @param oid The id of the commit
+ * @param all_parents If 0, diff only against the first parent. If
+ * GIT2R_LOG_NO_MERGES, merge commits are not diffed and get no rows.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_stats_diff_commit(
+    git2r_log_stats_commit *out,
+    git_repository *repository,
+    const git_oid *oid,
+    int all_parents)
+{
+    int error;
+    unsigned int i, n;
+    git_commit *commit = NULL;
+    git_tree *tree = NULL;
+
+    error = git_commit_lookup(&commit, repository, oid);
+    if (error)
+        goto cleanup;
+    error = git_commit_tree(&tree, commit);
+    if (error)
+        goto cleanup;
+
+    if (git_commit_author(commit)) {
+        const git_signature *author = git_commit_author(commit);
+        const char *email = author->email ? author->email : "";
+
+        out->when = author->when.time;
+        out->author = malloc(strlen(email) + 1);
+        if (!out->author) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+        strcpy(out->author, email);
+    }
+
+    n = git_commit_parentcount(commit);
+    if (n > 1 && all_parents == GIT2R_LOG_NO_MERGES)
+        goto cleanup;
+    if (n > 1 && !all_parents)
+        n = 1;
+
+    if (n) {
+        out->parents = malloc(n * sizeof(git_oid));
+        if (!out->parents) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < n || (i == 0 && n == 0); i++) {
+        git_commit *parent = NULL;
+        git_tree *parent_tree = NULL;
+        git_diff *diff = NULL;
+
+        if (n) {
+            error = git_commit_parent(&parent, commit, i);
+            if (!error)
+                error = git_commit_tree(&parent_tree, parent);
+            if (!error)
+                git_oid_cpy(&out->parents[i], git_commit_id(parent));
+        }
+
+        if (!error) {
+            error = git_diff_tree_to_tree(
+                &diff, repository, parent_tree, tree, NULL);
+        }
+        if (!error)
+            error = git2r_log_stats_append(out, diff, i);
+
+        git_diff_free(diff);
+        git_tree_free(parent_tree);
+        git_commit_free(parent);
+        if (error)
+            goto cleanup;
+    }
+    out->n_parents = n;
+
+cleanup:
+    git_tree_free(tree);
+    git_commit_free(commit);
+
+    return error;
+}
+
+/**
+ * Diff commits against their parents, with the commits split over
+ * 'n_threads' threads. Every thread opens its own handle of the
+ * repository and doesn't call the R API. An error is kept as a
+ * message on the commit that failed.
+ *
+ * @param commits The statistics of the commits
+ * @param oids The ids of the commits
+ * @param n_oids The number of commits
+ * @param path The path to the repository
+ * @param all_parents If 0, diff only against the first parent. If
+ * GIT2R_LOG_NO_MERGES, skip the merge commits.
+ * @param n_threads The number of threads
+ */
+static void
+git2r_log_stats_run(
+    git2r_log_stats_commit *commits,
+    const git_oid *oids,
+    size_t n_oids,
+    const char *path,
+    int all_parents,
+    int n_threads)
+{
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(n_threads)
+#endif
+    {
+        long i, n = (long)n_oids;
+        git_repository *repository = NULL;
+        int error = git_repository_open(&repository, path);
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 8)
+#endif
+        for (i = 0; i < n; i++) {
+            if (!error) {
+                error = git2r_log_stats_diff_commit(
+                    &commits[i], repository, &oids[i], all_parents);
+            }
+
+            if (error) {
+                const git_error *err = git_error_last();
+                const char *msg = (err && err->message) ? err->message :
+                    "Unable to diff commit";
+
+                commits[i].error = malloc(strlen(msg) + 1);
+                if (commits[i].error)
+                    strcpy(commits[i].error, msg);
+                if (repository)
+                    error = 0;
+            }
+        }
+
+        git_repository_free(repository);
+    }
+
+    GIT2R_UNUSED(n_threads);
+}
+
+/**
+ * Check that the commits to hide are a character vector with 40
+ * character sha's.
+ *
+ * @param hide The argument to check
+ * @return 0 if OK, else -1
+ */
+static int
+git2r_log_check_hide(
+    SEXP hide)
+{
+    R_xlen_t i;
+
+    if (git2r_arg_check_string_vec(hide))
+        return -1;
+    for (i = 0; i < Rf_xlength(hide); i++) {
+        SEXP elt = STRING_ELT(hide, i);
+        git_oid oid;
+
+        if (elt == NA_STRING || LENGTH(elt) != GIT_OID_HEXSZ ||
+            git_oid_fromstr(&oid, CHAR(elt)))
+            return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Walk the revisions, in the same order as commits(), and collect
+ * the commit ids.
+ *
+ * @param out The array to append the commit ids to
+ * @param repository The repository
+ * @param sha id of the commit to start from, or R_NilValue to start
+ * from HEAD.
+ * @param hide Character vector with the ids of the commits to hide
+ * together with their ancestors, or R_NilValue.
+ * @param max_n The upper limit of the number of commits. Use max_n
+ * < 0 for unlimited number of commits.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_collect(
+    git2r_oid_array *out,
+    git_repository *repository,
+    SEXP sha,
+    SEXP hide,
+    int max_n)
+{
+    R_xlen_t i;
+    int error;
+    git_oid oid;
+    git_revwalk *walker = NULL;
+
+    if (git_repository_is_empty(repository))
+        return GIT_OK;
+
+    error = git_revwalk_new(&walker, repository);
+    if (error)
+        goto cleanup;
+
+    if (Rf_isNull(sha)) {
+        error = git_revwalk_push_head(walker);
+    } else {
+        git2r_oid_from_sha_sexp(sha, &oid);
+        error = git_revwalk_push(walker, &oid);
+    }
+    if (error)
+        goto cleanup;
+
+    for (i = 0; !Rf_isNull(hide) && i < Rf_xlength(hide); i++) {
+        git_oid_fromstr(&oid, CHAR(STRING_ELT(hide, i)));
+        error = git_revwalk_hide(walker, &oid);
+        if (error)
+            goto cleanup;
+    }
+    git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
+
+    while (max_n < 0 || out->n < (size_t)max_n) {
+        error = git_revwalk_next(&oid, walker);
+        if (error) {
+            if (GIT_ITEROVER == error)
+                error = GIT_OK;
+            break;
+        }
+        error = git2r_oid_array_push(out, &oid);
+        if (error)
+            break;
+    }
+
+cleanup:
+    git_revwalk_free(walker);
+
+    return error;
+}
+
+/**
+ * Get the number of threads to use.
+ *
+ * @param nthreads The requested number of threads, or 0 to use one
+ * thread per processor.
+ * @return The number of threads. 1 if git2r is built without OpenMP
+ * or if libgit2 is not thread-safe.
+ */
+int attribute_hidden
+git2r_log_nthreads(
+    SEXP nthreads)
+{
+    int n_threads = INTEGER(nthreads)[0];
+
+#ifdef _OPENMP
+    if (n_threads == 0)
+        n_threads = omp_get_num_procs();
+#endif
+    if (n_threads < 1 || !(git_libgit2_features() & GIT_FEATURE_THREADS))
+        n_threads = 1;
+
+    return n_threads;
+}
+
+/**
+ * Diff every commit in a revision walk against its first parent, or
+ * all parents, and list the line statistics per file.
+ *
+ * @param repo S3 class git_repository
+ * @param sha id of the commit to start from, or R_NilValue to start
+ * from HEAD.
+ * @param hide Character vector with the ids of the commits to hide
+ * together with their ancestors, or R_NilValue.
+ * @param max_n The upper limit of the number of commits. Use max_n
+ * < 0 for unlimited number of commits.
+ * @param all_parents If TRUE, diff merge commits against all parents,
+ * else only against the first parent.
+ * @param nthreads The number of threads to use, or 0 to use one
+ * thread per processor.
+ * @return list with the columns sha, parent, path, status, additions
+ * and deletions.
+ */
+SEXP attribute_hidden
+git2r_log_stats(
+    SEXP repo,
+    SEXP sha,
+    SEXP hide,
+    SEXP max_n,
+    SEXP all_parents,
+    SEXP nthreads)
+{
+    const char *names[] = {"sha", "parent", "path", "status", "additions",
+                           "deletions", ""};
+    int error = GIT_OK, nprotect = 0;
+    SEXP result = R_NilValue;
+    size_t i, j, k, n_rows = 0;
+    char *msg = NULL;
+    git_repository *repository = NULL;
+    git2r_oid_array oids = GIT2R_OID_ARRAY_INIT;
+    git2r_log_stats_commit *commits = NULL;
+
+    if (!Rf_isNull(sha) && git2r_arg_check_sha(sha))
+        git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
+    if (!Rf_isNull(hide) && git2r_log_check_hide(hide))
+        git2r_error(__func__, NULL, "'hide'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_integer(max_n))
+        git2r_error(__func__, NULL, "'max_n'", git2r_err_integer_arg);
+    if (git2r_arg_check_logical(all_parents))
+        git2r_error(__func__, NULL, "'all_parents'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer_gte_zero(nthreads))
+        git2r_error(__func__, NULL, "'nthreads'", git2r_err_integer_gte_zero_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    error = git2r_log_collect(&oids, repository, sha, hide, INTEGER(max_n)[0]);
+    if (error)
+        goto cleanup;
+
+    if (oids.n) {
+        commits = calloc(oids.n, sizeof(git2r_log_stats_commit));
+        if (!commits) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+    }
+
+    git2r_log_stats_run(
+        commits, oids.oids, oids.n, git_repository_path(repository),
+        LOGICAL(all_parents)[0], git2r_log_nthreads(nthreads));
+
+    for (i = 0; i < oids.n; i++) {
+        if (commits[i].error) {
+            msg = R_alloc(strlen(commits[i].error) + 1, sizeof(char));
+            strcpy(msg, commits[i].error);
+            goto cleanup;
+        }
+        n_rows += commits[i].n;
+    }
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    nprotect++;
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n_rows));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP, n_rows));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(STRSXP, n_rows));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(STRSXP, n_rows));
+    SET_VECTOR_ELT(result, 4, Rf_allocVector(INTSXP, n_rows));
+    SET_VECTOR_ELT(result, 5, Rf_allocVector(INTSXP, n_rows));
+
+    for (i = 0, k = 0; i < oids.n; i++) {
+        char hex[GIT_OID_HEXSZ + 1];
+        SEXP commit_sha, parent_sha = NA_STRING;
+        unsigned int parent = (unsigned int)-1;
+
+        git_oid_tostr(hex, sizeof(hex), &oids.oids[i]);
+        PROTECT(commit_sha = Rf_mkChar(hex));
+
+        for (j = 0; j < commits[i].n; j++, k++) {
+            const git2r_log_stats_row *row = &commits[i].rows[j];
+
+            if (row->parent != parent) {
+                parent = row->parent;
+                parent_sha = NA_STRING;
+                if (parent < commits[i].n_parents) {
+                    git_oid_tostr(hex, sizeof(hex), &commits[i].parents[parent]);
+                    parent_sha = Rf_mkChar(hex);
+                }
+            }
+
+            SET_STRING_ELT(VECTOR_ELT(result, 0), k, commit_sha);
+            SET_STRING_ELT(VECTOR_ELT(result, 1), k, parent_sha);
+            SET_STRING_ELT(VECTOR_ELT(result, 2), k, Rf_mkChar(row->path));
+            SET_STRING_ELT(
+                VECTOR_ELT(result, 3), k,
+                Rf_mkChar(git2r_diff_status_name(row->status)));
+            INTEGER(VECTOR_ELT(result, 4))[k] = (int)row->additions;
+            INTEGER(VECTOR_ELT(result, 5))[k] = (int)row->deletions;
+        }
+
+        UNPROTECT(1);
+    }
+
+cleanup:
+    for (i = 0; commits && i < oids.n; i++)
+        git2r_log_stats_commit_free(&commits[i]);
+    free(commits);
+    git2r_oid_array_free(&oids);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (msg)
+        git2r_error(__func__, NULL, msg, NULL);
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * A table of distinct strings, where every string gets the index in
+ * the order it was added. The strings are found with an open
+ * addressing hash table.
+ */
+typedef struct {
+    char **strings;
+    size_t n;
+    size_t size;
+    size_t *slots;
+    size_t n_slots;
+} git2r_log_strtab;
+
+static size_t
+git2r_log_strhash(
+    const char *str)
+{
+    size_t h = 2166136261u;
+
+    for (; *str; str++)
+        h = (h ^ (unsigned char)*str) * 16777619u;
+
+    return h;
+}
+
+static void
+git2r_log_strtab_free(
+    git2r_log_strtab *tab)
+{
+    size_t i;
+
+    for (i = 0; i < tab->n; i++)
+        free(tab->strings[i]);
+    free(tab->strings);
+    free(tab->slots);
+    memset(tab, 0, sizeof(git2r_log_strtab));
+}
+
+/**
+ * Rehash the slots of a string table to hold 'n_slots' slots.
+ *
+ * @param tab The string table
+ * @param n_slots The number of slots, a power of two
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_strtab_rehash(
+    git2r_log_strtab *tab,
+    size_t n_slots)
+{
+    size_t i, *slots = calloc(n_slots, sizeof(size_t));
+
+    if (!slots) {
+        giterr_set_oom();
+        return GIT_ERROR_NOMEMORY;
+    }
+
+    for (i = 0; i < tab->n; i++) {
+        size_t j = git2r_log_strhash(tab->strings[i]) & (n_slots - 1);
+        while (slots[j])
+            j = (j + 1) & (n_slots - 1);
+        slots[j] = i + 1;
+    }
+
+    free(tab->slots);
+    tab->slots = slots;
+    tab->n_slots = n_slots;
+
+    return 0;
+}
+
+/**
+ * Find a string in a string table, and add it if it's not found.
+ *
+ * @param out The index of the string
+ * @param added Set to 1 if the string was added, else 0
+ * @param tab The string table
+ * @param str The string
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_strtab_insert(
+    size_t *out,
+    int *added,
+    git2r_log_strtab *tab,
+    const char *str)
+{
+    size_t j;
+
+    if (2 * (tab->n + 1) > tab->n_slots) {
+        int error = git2r_log_strtab_rehash(
+            tab, tab->n_slots ? 2 * tab->n_slots : 1024);
+        if (error)
+            return error;
+    }
+
+    j = git2r_log_strhash(str) & (tab->n_slots - 1);
+    while (tab->slots[j]) {
+        if (!strcmp(tab->strings[tab->slots[j] - 1], str)) {
+            *out = tab->slots[j] - 1;
+            *added = 0;
+            return 0;
+        }
+        j = (j + 1) & (tab->n_slots - 1);
+    }
+
+    if (tab->n == tab->size) {
+        size_t size = tab->size ? 2 * tab->size : 1024;
+        void *p = realloc(tab->strings, size * sizeof(char*));
+        if (!p) {
+            giterr_set_oom();
+            return GIT_ERROR_NOMEMORY;
+        }
+        tab->strings = p;
+        tab->size = size;
+    }
+
+    tab->strings[tab->n] = malloc(strlen(str) + 1);
+    if (!tab->strings[tab->n]) {
+        giterr_set_oom();
+        return GIT_ERROR_NOMEMORY;
+    }
+    strcpy(tab->strings[tab->n], str);
+    tab->slots[j] = tab->n + 1;
+    *out = tab->n++;
+    *added = 1;
+
+    return 0;
+}
+
+/**
+ * A set of (path, author) pairs to count the distinct authors of a
+ * path. A pair is stored as its key plus one, so zero is an empty
+ * slot.
+ */
+typedef struct {
+    unsigned long long *slots;
+    size_t n;
+    size_t n_slots;
+} git2r_log_pairset;
+
+/**
+ * Add a (path, author) pair to the set.
+ *
+ * @param added Set to 1 if the pair was added, else 0
+ * @param set The set
+ * @param path The index of the path
+ * @param author The index of the author
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_pairset_insert(
+    int *added,
+    git2r_log_pairset *set,
+    size_t path,
+    size_t author)
+{
+    unsigned long long key = (((unsigned long long)path << 32) | author) + 1;
+    size_t j;
+
+    if (2 * (set->n + 1) > set->n_slots) {
+        size_t i, n_slots = set->n_slots ? 2 * set->n_slots : 1024;
+        unsigned long long *slots = calloc(n_slots, sizeof(unsigned long long));
+
+        if (!slots) {
+            giterr_set_oom();
+            return GIT_ERROR_NOMEMORY;
+        }
+        for (i = 0; i < set->n_slots; i++) {
+            if (set->slots[i]) {
+                j = (size_t)(set->slots[i] * 0x9E3779B97F4A7C15ull >> 20) & (n_slots - 1);
+                while (slots[j])
+                    j = (j + 1) & (n_slots - 1);
+                slots[j] = set->slots[i];
+            }
+        }
+        free(set->slots);
+        set->slots = slots;
+        set->n_slots = n_slots;
+    }
+
+    j = (size_t)(key * 0x9E3779B97F4A7C15ull >> 20) & (set->n_slots - 1);
+    while (set->slots[j]) {
+        if (set->slots[j] == key) {
+            *added = 0;
+            return 0;
+        }
+        j = (j + 1) & (set->n_slots - 1);
+    }
+
+    set->slots[j] = key;
+    set->n++;
+    *added = 1;
+
+    return 0;
+}
+
+/**
+ * The churn of a path.
+ */
+typedef struct {
+    int commits;
+    int authors;
+    double additions;
+    double deletions;
+    git_time_t first;
+    git_time_t last;
+} git2r_log_churn_entry;
+
+/**
+ * The aggregated churn of all paths. The churn of a path has the
+ * same index as the path in 'paths'.
+ */
+typedef struct {
+    git2r_log_strtab paths;
+    git2r_log_strtab authors;
+    git2r_log_pairset path_authors;
+    git2r_log_churn_entry *churn;
+    size_t size;
+} git2r_log_churn_map;
+
+static void
+git2r_log_churn_map_free(
+    git2r_log_churn_map *map)
+{
+    git2r_log_strtab_free(&map->paths);
+    git2r_log_strtab_free(&map->authors);
+    free(map->path_authors.slots);
+    free(map->churn);
+    memset(map, 0, sizeof(git2r_log_churn_map));
+}
+
+/**
+ * Add the statistics of a commit to the churn of its paths.
+ *
+ * @param map The churn of all paths
+ * @param commit The statistics of the commit
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_log_churn_add(
+    git2r_log_churn_map *map,
+    const git2r_log_stats_commit *commit)
+{
+    int error, added;
+    size_t i, author;
+
+    error = git2r_log_strtab_insert(
+        &author, &added, &map->authors,
+        commit->author ? commit->author : "");
+    if (error)
+        return error;
+
+    for (i = 0; i < commit->n; i++) {
+        const git2r_log_stats_row *row = &commit->rows[i];
+        git2r_log_churn_entry *churn;
+        size_t path;
+
+        error = git2r_log_strtab_insert(
+            &path, &added, &map->paths, row->path);
+        if (error)
+            return error;
+
+        if (path == map->size) {
+            size_t size = map->size ? 2 * map->size : 1024;
+            void *p = realloc(map->churn, size * sizeof(git2r_log_churn_entry));
+            if (!p) {
+                giterr_set_oom();
+                return GIT_ERROR_NOMEMORY;
+            }
+            map->churn = p;
+            map->size = size;
+        }
+
+        churn = &map->churn[path];
+        if (added) {
+            memset(churn, 0, sizeof(git2r_log_churn_entry));
+            churn->first = churn->last = commit->when;
+        }
+
+        churn->commits++;
+        churn->additions += row->additions;
+        churn->deletions += row->deletions;
+        if (commit->when < churn->first)
+            churn->first = commit->when;
+        if (commit->when > churn->last)
+            churn->last = commit->when;
+
+        error = git2r_log_pairset_insert(
+            &added, &map->path_authors, path, author);
+        if (error)
+            return error;
+        churn->authors += added;
+    }
+
+    return 0;
+}
+
+static const char **git2r_log_churn_sort_paths;
+
+static int
+git2r_log_churn_cmp(
+    const void *a,
+    const void *b)
+{
+    return strcmp(git2r_log_churn_sort_paths[*(const size_t*)a],
+                  git2r_log_churn_sort_paths[*(const size_t*)b]);
+}
+
+/**
+ * The number of commits that are diffed before their statistics are
+ * added to the churn and released.
+ */
+#define GIT2R_LOG_CHURN_BATCH 4096
+
+/**
+ * Walk the history once, diff every commit against its first parent
+ * and aggregate the churn per path. Merge commits are skipped by
+ * default, as in 'git log --numstat', since the changes from a
+ * merged branch are already counted in the commits of the branch.
+ *
+ * The commits are diffed in batches, with the commits in a batch
+ * split over the threads as in git2r_log_stats, and the statistics
+ * of a batch are added to a hash map keyed by path before the next
+ * batch, so the memory use is bounded by the number of paths.
+ *
+ * @param repo S3 class git_repository
+ * @param sha id of the commit to start from, or R_NilValue to start
+ * from HEAD.
+ * @param hide Character vector with the ids of the commits to hide
+ * together with their ancestors, or R_NilValue.
+ * @param max_n The upper limit of the number of commits. Use max_n
+ * < 0 for unlimited number of commits.
+ * @param merges If TRUE, diff the merge commits against their first
+ * parent, else skip them.
+ * @param nthreads The number of threads to use, or 0 to use one
+ * thread per processor.
+ * @return list with the columns path, commits, additions, deletions,
+ * authors, first and last, sorted by path.
+ */
+SEXP attribute_hidden
+git2r_log_churn(
+    SEXP repo,
+    SEXP sha,
+    SEXP hide,
+    SEXP max_n,
+    SEXP merges,
+    SEXP nthreads)
+{
+    const char *names[] = {"path", "commits", "additions", "deletions",
+                           "authors", "first", "last", ""};
+    int error = GIT_OK, n_threads, nprotect = 0;
+    SEXP result = R_NilValue;
+    size_t i, start, *order = NULL;
+    char *msg = NULL;
+    git_repository *repository = NULL;
+    git2r_oid_array oids = GIT2R_OID_ARRAY_INIT;
+    git2r_log_stats_commit *commits = NULL;
+    git2r_log_churn_map map;
+
+    memset(&map, 0, sizeof(map));
+
+    if (!Rf_isNull(sha) && git2r_arg_check_sha(sha))
+        git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
+    if (!Rf_isNull(hide) && git2r_log_check_hide(hide))
+        git2r_error(__func__, NULL, "'hide'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_integer(max_n))
+        git2r_error(__func__, NULL, "'max_n'", git2r_err_integer_arg);
+    if (git2r_arg_check_logical(merges))
+        git2r_error(__func__, NULL, "'merges'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer_gte_zero(nthreads))
+        git2r_error(__func__, NULL, "'nthreads'", git2r_err_integer_gte_zero_arg);
+    n_threads = git2r_log_nthreads(nthreads);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    error = git2r_log_collect(&oids, repository, sha, hide, INTEGER(max_n)[0]);
+    if (error)
+        goto cleanup;
+
+    commits = calloc(GIT2R_LOG_CHURN_BATCH, sizeof(git2r_log_stats_commit));
+    if (!commits) {
+        giterr_set_oom();
+        error = GIT_ERROR_NOMEMORY;
+        goto cleanup;
+    }
+
+    for (start = 0; start < oids.n; start += GIT2R_LOG_CHURN_BATCH) {
+        size_t n = oids.n - start;
+
+        if (n > GIT2R_LOG_CHURN_BATCH)
+            n = GIT2R_LOG_CHURN_BATCH;
+
+        git2r_log_stats_run(
+            commits, oids.oids + start, n, git_repository_path(repository),
+            LOGICAL(merges)[0] ? 0 : GIT2R_LOG_NO_MERGES, n_threads);
+
+        for (i = 0; i < n && !error && !msg; i++) {
+            if (commits[i].error) {
+                msg = R_alloc(strlen(commits[i].error) + 1, sizeof(char));
+                strcpy(msg, commits[i].error);
+            } else {
+                error = git2r_log_churn_add(&map, &commits[i]);
+            }
+        }
+
+        for (i = 0; i < n; i++)
+            git2r_log_stats_commit_free(&commits[i]);
+        if (error || msg)
+            goto cleanup;
+    }
+
+    order = malloc((map.paths.n ? map.paths.n : 1) * sizeof(size_t));
+    if (!order) {
+        giterr_set_oom();
+        error = GIT_ERROR_NOMEMORY;
+        goto cleanup;
+    }
+    for (i = 0; i < map.paths.n; i++)
+        order[i] = i;
+    git2r_log_churn_sort_paths = (const char**)map.paths.strings;
+    qsort(order, map.paths.n, sizeof(size_t), git2r_log_churn_cmp);
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    nprotect++;
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, map.paths.n));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(INTSXP, map.paths.n));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(REALSXP, map.paths.n));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(REALSXP, map.paths.n));
+    SET_VECTOR_ELT(result, 4, Rf_allocVector(INTSXP, map.paths.n));
+    SET_VECTOR_ELT(result, 5, Rf_allocVector(REALSXP, map.paths.n));
+    SET_VECTOR_ELT(result, 6, Rf_allocVector(REALSXP, map.paths.n));
+
+    for (i = 0; i < map.paths.n; i++) {
+        const git2r_log_churn_entry *churn = &map.churn[order[i]];
+
+        SET_STRING_ELT(
+            VECTOR_ELT(result, 0), i,
+            Rf_mkChar(map.paths.strings[order[i]]));
+        INTEGER(VECTOR_ELT(result, 1))[i] = churn->commits;
+        REAL(VECTOR_ELT(result, 2))[i] = churn->additions;
+        REAL(VECTOR_ELT(result, 3))[i] = churn->deletions;
+        INTEGER(VECTOR_ELT(result, 4))[i] = churn->authors;
+        REAL(VECTOR_ELT(result, 5))[i] = (double)churn->first;
+        REAL(VECTOR_ELT(result, 6))[i] = (double)churn->last;
+    }
+
+cleanup:
+    free(order);
+    free(commits);
+    git2r_log_churn_map_free(&map);
+    git2r_oid_array_free(&oids);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (msg)
+        git2r_error(__func__, NULL, msg, NULL);
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
@@ -22,6 +22,7 @@
 #include "git2r_arg.h"
 #include "git2r_error.h"
 #include "git2r_note.h"
+#include "git2r_oid.h"
 #include "git2r_repository.h"
 #include "git2r_S3.h"
 #include "git2r_signature.h"
@@ -100,7 +101,8 @@ git2r_note_init(
  * Add a note for an object
  *
  * @param repo S3 class git_repository
- * @param sha The sha string of object
+ * @param sha The sha string of object, or a git_oid_vector with
+ * one oid.
  * @param commit S3 class git_commit
  * @param message Content of the note to add
  * @param ref Canonical name of the reference to use
@@ -130,6 +132,9 @@ git2r_note_create(
 
     if (git2r_arg_check_sha(sha))
         git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
+    /* The note is attached to the exact object id, not to a prefix. */
+    if (TYPEOF(sha) == STRSXP && LENGTH(STRING_ELT(sha, 0)) != GIT_OID_HEXSZ)
+        git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
     if (git2r_arg_check_string(message))
         git2r_error(__func__, NULL, "'message'", git2r_err_string_arg);
     if (git2r_arg_check_string(ref))
@@ -153,9 +158,7 @@ git2r_note_create(
     if (error)
         goto cleanup;
 
-    error = git_oid_fromstr(&object_oid, CHAR(STRING_ELT(sha, 0)));
-    if (error)
-        goto cleanup;
+    git2r_oid_from_sha_sexp(sha, &object_oid);
 
     if (LOGICAL(force)[0])
         overwrite = 1;
@@ -186,7 +189,7 @@ git2r_note_create(
 cleanup:
     git_signature_free(sig_author);
     git_signature_free(sig_committer);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -228,7 +231,7 @@ git2r_note_default_ref(
 
 cleanup:
     git_buf_dispose(&buf);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -353,7 +356,7 @@ git2r_notes(
 
 cleanup:
     git_buf_dispose(&buf);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -421,7 +424,7 @@ git2r_note_remove(
 cleanup:
     git_signature_free(sig_author);
     git_signature_free(sig_committer);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
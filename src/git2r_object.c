@@ -23,6 +23,7 @@
 #include "git2r_blob.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_oid.h"
 #include "git2r_repository.h"
 #include "git2r_S3.h"
 #include "git2r_tag.h"
@@ -54,9 +55,9 @@ git2r_object_lookup(
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    len = LENGTH(STRING_ELT(sha, 0));
+    len = TYPEOF(sha) == RAWSXP ? GIT_OID_HEXSZ : LENGTH(STRING_ELT(sha, 0));
     if (GIT_OID_HEXSZ == len) {
-        git_oid_fromstr(&oid, CHAR(STRING_ELT(sha, 0)));
+        git2r_oid_from_sha_sexp(sha, &oid);
         error = git_object_lookup(&object, repository, &oid, GIT_OBJECT_ANY);
         if (error)
             goto cleanup;
@@ -102,7 +103,7 @@ git2r_object_lookup(
 
 cleanup:
     git_object_free(object);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -18,11 +18,21 @@
 
 #include <R_ext/Visibility.h>
 #include <git2.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
 #include "git2r_odb.h"
+#include "git2r_oid.h"
 #include "git2r_repository.h"
+#include "git2r_sha1.h"
 
 /**
  * Determine the sha of character vectors without writing to the
@@ -72,15 +82,35 @@ git2r_odb_hash(
 }
 
 /**
- * Determine the sha of files without writing to the object data
- * base.
+ * Format the sha of a hash.
  *
- * @param path STRSXP with file vectors to hash
+ * @param raw The 20 bytes of the hash
+ * @return A CHARSXP with the 40 character hexadecimal sha
+ */
+static SEXP
+git2r_odb_hash_sha(
+    const unsigned char *raw)
+{
+    char sha[GIT_OID_HEXSZ + 1];
+    git_oid oid;
+
+    git_oid_fromraw(&oid, raw);
+    git_oid_tostr(sha, sizeof(sha), &oid);
+
+    return Rf_mkChar(sha);
+}
+
+/**
+ * Determine the sha of raw vectors without writing to the object
+ * data base.
+ *
+ * @param data VECSXP with raw vectors to hash. A NULL element gives
+ * NA.
  * @return A STRSXP with character vector of sha values
  */
 SEXP attribute_hidden
-git2r_odb_hashfile(
-    SEXP path)
+git2r_odb_hash_raw(
+    SEXP data)
 {
     SEXP result;
     int error = GIT_OK;
@@ -88,25 +118,31 @@ git2r_odb_hashfile(
     char sha[GIT_OID_HEXSZ + 1];
     git_oid oid;
 
-    if (git2r_arg_check_string_vec(path))
-        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+    if (!Rf_isNewList(data))
+        git2r_error(__func__, NULL, "'data'", git2r_err_raw_list_arg);
+    len = Rf_xlength(data);
+    for (i = 0; i < len; i++) {
+        SEXP item = VECTOR_ELT(data, i);
+        if (!Rf_isNull(item) && TYPEOF(item) != RAWSXP)
+            git2r_error(__func__, NULL, "'data'", git2r_err_raw_list_arg);
+    }
 
-    len = Rf_length(path);
     PROTECT(result = Rf_allocVector(STRSXP, len));
     for (i = 0; i < len; i++) {
-        if (NA_STRING == STRING_ELT(path, i)) {
-            SET_STRING_ELT(result, i, NA_STRING);
-        } else {
-            error = git_odb_hashfile(&oid,
-                                   CHAR(STRING_ELT(path, i)),
-                                   GIT_OBJECT_BLOB);
-            if (error)
-                break;
+        SEXP item = VECTOR_ELT(data, i);
 
-            git_oid_fmt(sha, &oid);
-            sha[GIT_OID_HEXSZ] = '\0';
-            SET_STRING_ELT(result, i, Rf_mkChar(sha));
+        if (Rf_isNull(item)) {
+            SET_STRING_ELT(result, i, NA_STRING);
+            continue;
         }
+
+        error = git_odb_hash(&oid, RAW(item), Rf_xlength(item), GIT_OBJECT_BLOB);
+        if (error)
+            break;
+
+        git_oid_fmt(sha, &oid);
+        sha[GIT_OID_HEXSZ] = '\0';
+        SET_STRING_ELT(result, i, Rf_mkChar(sha));
     }
 
     UNPROTECT(1);
@@ -118,48 +154,254 @@ git2r_odb_hashfile(
 }
 
 /**
- * Data structure to hold information when iterating over objects.
+ * The state to hash a blob that is fed in chunks. The state is kept
+ * in a raw vector between the calls, so it needs no finalizer.
  */
 typedef struct {
-    size_t n;
-    SEXP list;
-    git_odb *odb;
-} git2r_odb_objects_cb_data;
+    git2r_sha1_ctx sha1;
+    double size;
+    double n;
+} git2r_odb_hash_ctx;
 
 /**
- * Add object
+ * Copy the hash context from a raw vector
  *
- * @param oid Oid of the object
- * @param list The list to hold the S3 class git_object
- * @param i The index to the list item
- * @param type The type of the object
- * @param len The length of the object
- * @param repo The S3 class that contains the object
- * @return void
+ * @param ctx The context
+ * @param arg The raw vector
+ * @return 0 if OK, else -1
  */
-static void
-git2r_add_object(
-    const git_oid *oid,
-    SEXP list,
-    size_t i,
-    const char *type,
-    size_t len)
+static int
+git2r_odb_hash_ctx_get(
+    git2r_odb_hash_ctx *ctx,
+    SEXP arg)
 {
-    int j = 0;
-    char sha[GIT_OID_HEXSZ + 1];
+    if (TYPEOF(arg) != RAWSXP || Rf_xlength(arg) != sizeof(git2r_odb_hash_ctx))
+        return -1;
+    memcpy(ctx, RAW(arg), sizeof(git2r_odb_hash_ctx));
+    return 0;
+}
+
+/**
+ * Copy the hash context to a new raw vector
+ *
+ * @param ctx The context
+ * @return The raw vector
+ */
+static SEXP
+git2r_odb_hash_ctx_sexp(
+    const git2r_odb_hash_ctx *ctx)
+{
+    SEXP result = Rf_allocVector(RAWSXP, sizeof(git2r_odb_hash_ctx));
+    memcpy(RAW(result), ctx, sizeof(git2r_odb_hash_ctx));
+    return result;
+}
+
+/**
+ * Start to hash a blob that is fed in chunks
+ *
+ * The size of the blob is part of the header that is hashed before
+ * the content, so it must be known before the first chunk.
+ * @param size The size of the blob in bytes
+ * @return A raw vector with the hash context
+ */
+SEXP attribute_hidden
+git2r_odb_hash_init(
+    SEXP size)
+{
+    char header[64];
+    git2r_odb_hash_ctx ctx;
+
+    if (!Rf_isNumeric(size) || Rf_length(size) != 1 ||
+        !R_FINITE(Rf_asReal(size)) || Rf_asReal(size) < 0 ||
+        Rf_asReal(size) != floor(Rf_asReal(size)))
+        git2r_error(__func__, NULL, "'size'", git2r_err_number_gte_zero_arg);
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.size = Rf_asReal(size);
+    snprintf(header, sizeof(header), "blob %.0f", ctx.size);
+    git2r_sha1_init(&ctx.sha1);
+    git2r_sha1_update(&ctx.sha1, header, strlen(header) + 1);
+
+    return git2r_odb_hash_ctx_sexp(&ctx);
+}
+
+/**
+ * Add a chunk to a hash context
+ *
+ * @param ctx A raw vector with the hash context
+ * @param data A raw vector with the chunk
+ * @return A raw vector with the updated hash context
+ */
+SEXP attribute_hidden
+git2r_odb_hash_update(
+    SEXP ctx,
+    SEXP data)
+{
+    git2r_odb_hash_ctx c;
+
+    if (git2r_odb_hash_ctx_get(&c, ctx))
+        git2r_error(__func__, NULL, "'ctx'", git2r_err_hash_context_arg);
+    if (TYPEOF(data) != RAWSXP)
+        git2r_error(__func__, NULL, "'data'", git2r_err_raw_list_arg);
+
+    c.n += (double)Rf_xlength(data);
+    if (c.n > c.size)
+        git2r_error(__func__, NULL, git2r_err_hash_size, NULL);
+    git2r_sha1_update(&c.sha1, RAW(data), Rf_xlength(data));
+
+    return git2r_odb_hash_ctx_sexp(&c);
+}
+
+/**
+ * Finish a hash context
+ *
+ * @param ctx A raw vector with the hash context
+ * @return A STRSXP with the sha value
+ */
+SEXP attribute_hidden
+git2r_odb_hash_final(
+    SEXP ctx)
+{
+    SEXP result;
+    unsigned char raw[20];
+    git2r_odb_hash_ctx c;
+
+    if (git2r_odb_hash_ctx_get(&c, ctx))
+        git2r_error(__func__, NULL, "'ctx'", git2r_err_hash_context_arg);
+    if (c.n != c.size)
+        git2r_error(__func__, NULL, git2r_err_hash_size, NULL);
+
+    git2r_sha1_final(raw, &c.sha1);
+    PROTECT(result = Rf_allocVector(STRSXP, 1));
+    SET_STRING_ELT(result, 0, git2r_odb_hash_sha(raw));
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Determine the sha of files without writing to the object data
+ * base.
+ *
+ * The files are hashed by 'nthreads' threads when git2r is built
+ * with OpenMP and libgit2 is thread-safe. The threads don't call the
+ * R API: the oids and error messages are written to preallocated C
+ * arrays, and the result is created when all files have been
+ * hashed. A file that cannot be hashed gives NA, and its error
+ * message is in the attribute 'message' of the result, with NA for
+ * the other elements.
+ *
+ * @param path STRSXP with file vectors to hash
+ * @param nthreads The number of threads to use, or 0 to use one
+ * thread per processor.
+ * @return A STRSXP with character vector of sha values
+ */
+SEXP attribute_hidden
+git2r_odb_hashfile(
+    SEXP path,
+    SEXP nthreads)
+{
+    SEXP result, message = R_NilValue;
+    int i, len, n_threads, nprotect = 0;
+    const char **paths = NULL;
+    git_oid *oids = NULL;
+    char **errors = NULL;
+    char *failed = NULL;
+
+    if (git2r_arg_check_string_vec(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_integer_gte_zero(nthreads))
+        git2r_error(__func__, NULL, "'nthreads'", git2r_err_integer_gte_zero_arg);
+
+    len = Rf_length(path);
+    paths = (const char**)R_alloc(len, sizeof(char*));
+    oids = (git_oid*)R_alloc(len, sizeof(git_oid));
+    failed = R_alloc(len, sizeof(char));
+    errors = (char**)R_alloc(len, sizeof(char*));
+    for (i = 0; i < len; i++) {
+        if (NA_STRING == STRING_ELT(path, i))
+            paths[i] = NULL;
+        else
+            paths[i] = CHAR(STRING_ELT(path, i));
+        failed[i] = 0;
+        errors[i] = NULL;
+    }
+
+    n_threads = INTEGER(nthreads)[0];
+#ifdef _OPENMP
+    if (n_threads == 0)
+        n_threads = omp_get_num_procs();
+#endif
+    if (n_threads < 1 || !(git_libgit2_features() & GIT_FEATURE_THREADS))
+        n_threads = 1;
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(n_threads) schedule(dynamic, 16)
+#endif
+    for (i = 0; i < len; i++) {
+        if (paths[i] &&
+            git_odb_hashfile(&oids[i], paths[i], GIT_OBJECT_BLOB)) {
+            const git_error *err = git_error_last();
+            const char *msg = (err && err->message) ? err->message :
+                "Unable to hash file";
+
+            failed[i] = 1;
+            errors[i] = malloc(strlen(msg) + 1);
+            if (errors[i])
+                strcpy(errors[i], msg);
+        }
+    }
+
+    PROTECT(result = Rf_allocVector(STRSXP, len));
+    nprotect++;
+    for (i = 0; i < len; i++) {
+        char sha[GIT_OID_HEXSZ + 1];
+
+        if (!paths[i] || failed[i]) {
+            SET_STRING_ELT(result, i, NA_STRING);
+            if (failed[i]) {
+                if (Rf_isNull(message)) {
+                    int j;
+                    PROTECT(message = Rf_allocVector(STRSXP, len));
+                    nprotect++;
+                    for (j = 0; j < len; j++)
+                        SET_STRING_ELT(message, j, NA_STRING);
+                }
+                SET_STRING_ELT(message, i, Rf_mkChar(
+                                   errors[i] ? errors[i] : "Unable to hash file"));
+                free(errors[i]);
+                errors[i] = NULL;
+            }
+            continue;
+        }
+
+        git_oid_fmt(sha, &oids[i]);
+        sha[GIT_OID_HEXSZ] = '\0';
+        SET_STRING_ELT(result, i, Rf_mkChar(sha));
+    }
 
-    /* Sha */
-    git_oid_fmt(sha, oid);
-    sha[GIT_OID_HEXSZ] = '\0';
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(sha));
+    if (!Rf_isNull(message))
+        Rf_setAttrib(result, Rf_install("message"), message);
 
-    /* Type */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(type));
+    UNPROTECT(nprotect);
 
-    /* Length */
-    INTEGER(VECTOR_ELT(list, j++))[i] = (int)len;
+    return result;
 }
 
+/**
+ * Data structure to hold information when iterating over objects.
+ */
+typedef struct {
+    git_odb *odb;
+    int header;
+    unsigned int types;
+    git_oid *oids;
+    git_object_t *type;
+    size_t *len;
+    size_t n;
+    size_t size;
+} git2r_odb_objects_cb_data;
+
 /**
  * Callback when iterating over objects
  *
@@ -173,57 +415,116 @@ git2r_odb_objects_cb(
     void *payload)
 {
     int error;
-    size_t len;
-    git_object_t type;
+    size_t len = 0;
+    git_object_t type = GIT_OBJECT_INVALID;
     git2r_odb_objects_cb_data *p = (git2r_odb_objects_cb_data*)payload;
 
-    error = git_odb_read_header(&len, &type, p->odb, oid);
-    if (error)
-        return error;
+    if (p->header) {
+        error = git_odb_read_header(&len, &type, p->odb, oid);
+        if (error)
+            return error;
 
-    switch(type) {
-    case GIT_OBJECT_COMMIT:
-        if (!Rf_isNull(p->list))
-            git2r_add_object(oid, p->list, p->n, "commit", len);
-        break;
-    case GIT_OBJECT_TREE:
-        if (!Rf_isNull(p->list))
-            git2r_add_object(oid, p->list, p->n, "tree", len);
-        break;
-    case GIT_OBJECT_BLOB:
-        if (!Rf_isNull(p->list))
-            git2r_add_object(oid, p->list, p->n, "blob", len);
-        break;
-    case GIT_OBJECT_TAG:
-        if (!Rf_isNull(p->list))
-            git2r_add_object(oid, p->list, p->n, "tag", len);
-        break;
-    default:
-        return 0;
+        switch(type) {
+        case GIT_OBJECT_COMMIT:
+        case GIT_OBJECT_TREE:
+        case GIT_OBJECT_BLOB:
+        case GIT_OBJECT_TAG:
+            if (!(p->types & (1u << type)))
+                return 0;
+            break;
+        default:
+            return 0;
+        }
     }
 
-    p->n += 1;
+    if (p->n == p->size) {
+        size_t size = p->size ? 2 * p->size : 4096;
+        git_oid *oids = realloc(p->oids, size * sizeof(git_oid));
+        if (!oids)
+            goto oom;
+        p->oids = oids;
+        if (p->header) {
+            git_object_t *types = realloc(p->type, size * sizeof(git_object_t));
+            size_t *lens;
+            if (!types)
+                goto oom;
+            p->type = types;
+            lens = realloc(p->len, size * sizeof(size_t));
+            if (!lens)
+                goto oom;
+            p->len = lens;
+        }
+        p->size = size;
+    }
+
+    git_oid_cpy(&p->oids[p->n], oid);
+    if (p->header) {
+        p->type[p->n] = type;
+        p->len[p->n] = len;
+    }
+    p->n++;
 
     return 0;
+
+oom:
+    giterr_set_oom();
+    return GIT_ERROR_NOMEMORY;
 }
 
 /**
  * List all objects available in the database
  *
+ * The objects are enumerated once into growable buffers that are
+ * copied into the list when the enumeration is done.
  * @param repo S3 class git_repository
- * @return list with sha's for commit's, tree's, blob's and tag's
+ * @param type Character vector with the types of objects to list,
+ * or R_NilValue to list commit's, tree's, blob's and tag's.
+ * @param header Read the header of each object to determine the
+ * type and the length. If FALSE, only the sha's of all objects are
+ * listed.
+ * @param oid_vector If TRUE, return the sha's as a git_oid_vector
+ * instead of formatting them as hexadecimal strings.
+ * @return list with sha's, types and lengths of the objects
  */
 SEXP attribute_hidden
 git2r_odb_objects(
-    SEXP repo)
+    SEXP repo,
+    SEXP type,
+    SEXP header,
+    SEXP oid_vector)
 {
-    const char *names[] = {"sha", "type", "len", ""};
-    int i, error, nprotect = 0;
+    int error, nprotect = 0;
+    size_t i;
     SEXP result = R_NilValue;
-    git2r_odb_objects_cb_data cb_data = {0, R_NilValue, NULL};
+    SEXP sha, obj_type = R_NilValue, len = R_NilValue;
+    git2r_odb_objects_cb_data cb_data = {NULL, 1, 0, NULL, NULL, NULL, 0, 0};
     git_odb *odb = NULL;
     git_repository *repository = NULL;
 
+    if (!Rf_isNull(type) && git2r_arg_check_string_vec(type))
+        git2r_error(__func__, NULL, "'type'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_logical(header))
+        git2r_error(__func__, NULL, "'header'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(oid_vector))
+        git2r_error(__func__, NULL, "'oid_vector'", git2r_err_logical_arg);
+
+    cb_data.header = LOGICAL(header)[0];
+    if (Rf_isNull(type)) {
+        cb_data.types = (1u << GIT_OBJECT_COMMIT) | (1u << GIT_OBJECT_TREE) |
+            (1u << GIT_OBJECT_BLOB) | (1u << GIT_OBJECT_TAG);
+    } else {
+        for (i = 0; i < (size_t)Rf_length(type); i++) {
+            git_object_t t;
+
+            if (NA_STRING == STRING_ELT(type, i))
+                git2r_error(__func__, NULL, "'type'", git2r_err_string_vec_arg);
+            t = git_object_string2type(CHAR(STRING_ELT(type, i)));
+            if (t < GIT_OBJECT_COMMIT || t > GIT_OBJECT_TAG)
+                git2r_error(__func__, NULL, git2r_err_object_type, NULL);
+            cb_data.types |= 1u << t;
+        }
+    }
+
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -233,25 +534,50 @@ git2r_odb_objects(
         goto cleanup;
     cb_data.odb = odb;
 
-    /* Count number of objects before creating the list */
     error = git_odb_foreach(odb, &git2r_odb_objects_cb, &cb_data);
     if (error)
         goto cleanup;
 
-    PROTECT(result = Rf_mkNamed(VECSXP, names));
-    nprotect++;
+    if (cb_data.header) {
+        const char *names[] = {"sha", "type", "len", ""};
+        PROTECT(result = Rf_mkNamed(VECSXP, names));
+        nprotect++;
+        SET_VECTOR_ELT(result, 1, obj_type = Rf_allocVector(STRSXP, cb_data.n));
+        SET_VECTOR_ELT(result, 2, len = Rf_allocVector(INTSXP, cb_data.n));
+    } else {
+        const char *names[] = {"sha", ""};
+        PROTECT(result = Rf_mkNamed(VECSXP, names));
+        nprotect++;
+    }
 
-    i = 0;
-    SET_VECTOR_ELT(result, i++,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i++,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(INTSXP,  cb_data.n));
+    if (LOGICAL(oid_vector)[0])
+        SET_VECTOR_ELT(result, 0, sha = git2r_oid_vector_alloc(cb_data.n));
+    else
+        SET_VECTOR_ELT(result, 0, sha = Rf_allocVector(STRSXP, cb_data.n));
 
-    cb_data.list = result;
-    cb_data.n = 0;
-    error = git_odb_foreach(odb, &git2r_odb_objects_cb, &cb_data);
+    for (i = 0; i < cb_data.n; i++) {
+        if (LOGICAL(oid_vector)[0]) {
+            git2r_oid_vector_set(sha, i, &cb_data.oids[i]);
+        } else {
+            char hex[GIT_OID_HEXSZ + 1];
+
+            git_oid_fmt(hex, &cb_data.oids[i]);
+            hex[GIT_OID_HEXSZ] = '\0';
+            SET_STRING_ELT(sha, i, Rf_mkChar(hex));
+        }
+
+        if (cb_data.header) {
+            SET_STRING_ELT(obj_type, i,
+                           Rf_mkChar(git_object_type2string(cb_data.type[i])));
+            INTEGER(len)[i] = (int)cb_data.len[i];
+        }
+    }
 
 cleanup:
-    git_repository_free(repository);
+    free(cb_data.oids);
+    free(cb_data.type);
+    free(cb_data.len);
+    git2r_repository_close(repository);
     git_odb_free(odb);
 
     if (nprotect)
@@ -264,241 +590,596 @@ cleanup:
 }
 
 /**
- * Data structure to hold information when iterating over blobs.
+ * A blob or a sub-tree in a cached tree.
+ */
+typedef struct {
+    git_oid oid;
+    const char *name;
+    int is_tree;
+    size_t len; /* The length of a blob, or the node of a sub-tree. */
+} git2r_odb_tree_item;
+
+/**
+ * A tree in the tree cache. The items are in the order of the
+ * entries in the tree.
+ */
+typedef struct {
+    git_oid oid;
+    git2r_odb_tree_item *items;
+    size_t n_items;
+    char *names;
+    size_t n_blobs; /* The number of blobs in the tree and sub-trees. */
+} git2r_odb_tree_node;
+
+/**
+ * Cache of the blobs and sub-trees of every tree visited when
+ * listing blobs. Commits share most of their sub-trees, so every
+ * distinct tree is read once and every blob length is looked up
+ * once. The nodes are found by tree id in an open addressing hash
+ * table, where a slot holds the node index plus one, or zero if the
+ * slot is empty.
  */
 typedef struct {
-    size_t n;
-    SEXP list;
     git_repository *repository;
     git_odb *odb;
-} git2r_odb_blobs_cb_data;
+    git2r_odb_tree_node *nodes;
+    size_t n;
+    size_t size;
+    size_t *slots;
+    size_t n_slots;
+} git2r_odb_tree_cache;
+
+static size_t
+git2r_odb_tree_cache_hash(
+    const git_oid *oid)
+{
+    size_t h = 0;
+    size_t i;
+
+    /* The oid is already a hash, use its first bytes. */
+    for (i = 0; i < sizeof(size_t); i++)
+        h = (h << 8) | oid->id[i];
+    return h;
+}
+
+/**
+ * Find the slot of a tree in the hash table
+ *
+ * @param cache The tree cache
+ * @param oid The id of the tree
+ * @return The slot with the tree, or the empty slot for the tree.
+ */
+static size_t
+git2r_odb_tree_cache_slot(
+    const git2r_odb_tree_cache *cache,
+    const git_oid *oid)
+{
+    size_t mask = cache->n_slots - 1;
+    size_t slot = git2r_odb_tree_cache_hash(oid) & mask;
+
+    while (cache->slots[slot] &&
+           !git_oid_equal(&cache->nodes[cache->slots[slot] - 1].oid, oid))
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
 
 /**
- * Add blob entry to list
+ * Add a node to the cache
  *
- * @param entry The tree entry (blob) to add
- * @param odb The object database
- * @param list The list to hold the blob information
- * @param i The vector index of the list items to use for the blob information
- * @param path The path to the tree relative to the repository workdir
- * @param commit The commit that contains the root tree of the iteration
- * @param author The author of the commit
- * @param when Time of the commit
+ * @param cache The tree cache
+ * @param node The node to add. The cache takes ownership of the
+ * items and names of the node.
  * @return 0 or error code
  */
 static int
-git2r_odb_add_blob(
-    const git_tree_entry *entry,
-    git_odb *odb,
-    SEXP list,
-    size_t i,
-    const char *path,
-    const char *commit,
-    const char *author,
-    double when)
+git2r_odb_tree_cache_add(
+    git2r_odb_tree_cache *cache,
+    const git2r_odb_tree_node *node)
 {
-    int error;
-    int j = 0;
-    size_t len;
-    git_object_t type;
-    char sha[GIT_OID_HEXSZ + 1];
+    size_t i;
+
+    if (cache->n == cache->size) {
+        size_t size = cache->size ? 2 * cache->size : 256;
+        git2r_odb_tree_node *nodes =
+            realloc(cache->nodes, size * sizeof(git2r_odb_tree_node));
+        if (!nodes)
+            goto oom;
+        cache->nodes = nodes;
+        cache->size = size;
+    }
 
-    /* Sha */
-    git_oid_fmt(sha, git_tree_entry_id(entry));
-    sha[GIT_OID_HEXSZ] = '\0';
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(sha));
+    /* Keep the load factor of the hash table below 1/2. */
+    if (2 * (cache->n + 1) > cache->n_slots) {
+        size_t n_slots = cache->n_slots ? 2 * cache->n_slots : 1024;
+        size_t *slots = calloc(n_slots, sizeof(size_t));
+        if (!slots)
+            goto oom;
+        free(cache->slots);
+        cache->slots = slots;
+        cache->n_slots = n_slots;
+        for (i = 0; i < cache->n; i++) {
+            size_t slot = git2r_odb_tree_cache_slot(cache, &cache->nodes[i].oid);
+            cache->slots[slot] = i + 1;
+        }
+    }
 
-    /* Path */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(path));
+    cache->nodes[cache->n] = *node;
+    cache->slots[git2r_odb_tree_cache_slot(cache, &node->oid)] = ++cache->n;
 
-    /* Name */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(git_tree_entry_name(entry)));
+    return GIT_OK;
 
-    /* Length */
-    error = git_odb_read_header(&len, &type, odb, git_tree_entry_id(entry));
+oom:
+    giterr_set_oom();
+    return GIT_ERROR_NOMEMORY;
+}
+
+/**
+ * Get the node of a tree, reading the tree and its sub-trees if
+ * they are not in the cache.
+ *
+ * @param out The index of the node in the cache
+ * @param cache The tree cache
+ * @param oid The id of the tree
+ * @return 0 or error code
+ */
+static int
+git2r_odb_tree_cache_get(
+    size_t *out,
+    git2r_odb_tree_cache *cache,
+    const git_oid *oid)
+{
+    int error;
+    size_t i, j, names_len = 0;
+    git_tree *tree = NULL;
+    git2r_odb_tree_node node;
+
+    if (cache->n_slots) {
+        size_t slot = git2r_odb_tree_cache_slot(cache, oid);
+        if (cache->slots[slot]) {
+            *out = cache->slots[slot] - 1;
+            return GIT_OK;
+        }
+    }
+
+    error = git_tree_lookup(&tree, cache->repository, oid);
     if (error)
         return error;
-    INTEGER(VECTOR_ELT(list, j++))[i] = (int)len;
 
-    /* Commit sha */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(commit));
+    memset(&node, 0, sizeof(node));
+    git_oid_cpy(&node.oid, oid);
+    for (i = 0; i < git_tree_entrycount(tree); i++) {
+        const git_tree_entry *entry = git_tree_entry_byindex(tree, i);
+        git_object_t type = git_tree_entry_type(entry);
+        if (type == GIT_OBJECT_TREE || type == GIT_OBJECT_BLOB) {
+            node.n_items++;
+            names_len += strlen(git_tree_entry_name(entry)) + 1;
+        }
+    }
+
+    if (node.n_items) {
+        node.items = malloc(node.n_items * sizeof(git2r_odb_tree_item));
+        node.names = malloc(names_len);
+        if (!node.items || !node.names) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+    }
+
+    for (i = 0, j = 0, names_len = 0; i < git_tree_entrycount(tree); i++) {
+        const git_tree_entry *entry = git_tree_entry_byindex(tree, i);
+        git2r_odb_tree_item *item = &node.items[j];
+        git_object_t type = git_tree_entry_type(entry);
+        const char *name = git_tree_entry_name(entry);
 
-    /* Author */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(author));
+        if (type != GIT_OBJECT_TREE && type != GIT_OBJECT_BLOB)
+            continue;
 
-    /* When */
-    REAL(VECTOR_ELT(list, j++))[i] = when;
+        git_oid_cpy(&item->oid, git_tree_entry_id(entry));
+        item->name = node.names + names_len;
+        strcpy(node.names + names_len, name);
+        names_len += strlen(name) + 1;
+
+        if (type == GIT_OBJECT_TREE) {
+            item->is_tree = 1;
+            error = git2r_odb_tree_cache_get(&item->len, cache, &item->oid);
+            if (error)
+                goto cleanup;
+            node.n_blobs += cache->nodes[item->len].n_blobs;
+        } else {
+            git_object_t blob_type;
+            item->is_tree = 0;
+            error = git_odb_read_header(&item->len, &blob_type,
+                                        cache->odb, &item->oid);
+            if (error)
+                goto cleanup;
+            node.n_blobs++;
+        }
+
+        j++;
+    }
+
+    error = git2r_odb_tree_cache_add(cache, &node);
+    if (!error) {
+        *out = cache->n - 1;
+        node.items = NULL;
+        node.names = NULL;
+    }
+
+cleanup:
+    free(node.items);
+    free(node.names);
+    git_tree_free(tree);
+
+    return error;
+}
+
+/**
+ * Free the tree cache
+ *
+ * @param cache The tree cache
+ * @return void
+ */
+static void
+git2r_odb_tree_cache_free(
+    git2r_odb_tree_cache *cache)
+{
+    size_t i;
+
+    for (i = 0; i < cache->n; i++) {
+        free(cache->nodes[i].items);
+        free(cache->nodes[i].names);
+    }
+    free(cache->nodes);
+    free(cache->slots);
+}
+
+/**
+ * A set of (object id, path, name) keys used to skip sub-trees and
+ * blobs that have already been listed at the same path.
+ */
+typedef struct {
+    git_oid oid;
+    const char *path;
+    const char *name;
+    size_t hash;
+} git2r_odb_path_key;
+
+typedef struct {
+    git2r_odb_path_key *keys;
+    size_t n;
+    size_t n_slots;
+} git2r_odb_path_set;
+
+static size_t
+git2r_odb_path_key_hash(
+    const git_oid *oid,
+    const char *path,
+    const char *name)
+{
+    size_t h = git2r_odb_tree_cache_hash(oid);
+
+    while (*path)
+        h = (h ^ (unsigned char)*path++) * 1099511628211u;
+    h = (h ^ '/') * 1099511628211u;
+    while (name && *name)
+        h = (h ^ (unsigned char)*name++) * 1099511628211u;
+
+    return h;
+}
+
+/**
+ * Find the slot of a key in the set
+ *
+ * @param set The set
+ * @param oid The object id
+ * @param path The path of the tree that contains the object
+ * @param name The name of the object, or NULL
+ * @param hash The hash of the key
+ * @return The slot with the key, or the empty slot for the key.
+ */
+static size_t
+git2r_odb_path_set_slot(
+    const git2r_odb_path_set *set,
+    const git_oid *oid,
+    const char *path,
+    const char *name,
+    size_t hash)
+{
+    size_t slot, mask = set->n_slots - 1;
+
+    for (slot = hash & mask; set->keys[slot].path; slot = (slot + 1) & mask) {
+        const git2r_odb_path_key *key = &set->keys[slot];
+        if (key->hash == hash &&
+            git_oid_equal(&key->oid, oid) &&
+            !strcmp(key->path, path) &&
+            (key->name == name || (key->name && name && !strcmp(key->name, name))))
+            break;
+    }
+
+    return slot;
+}
+
+/**
+ * Check if the set contains a key
+ *
+ * @param set The set
+ * @param oid The object id
+ * @param path The path of the tree that contains the object
+ * @param name The name of the object, or NULL
+ * @return 1 if the set contains the key, else 0.
+ */
+static int
+git2r_odb_path_set_contains(
+    const git2r_odb_path_set *set,
+    const git_oid *oid,
+    const char *path,
+    const char *name)
+{
+    size_t hash;
+
+    if (!set->n)
+        return 0;
+    hash = git2r_odb_path_key_hash(oid, path, name);
+    return set->keys[git2r_odb_path_set_slot(set, oid, path, name, hash)].path != NULL;
+}
+
+/**
+ * Insert a key that is not in the set
+ *
+ * @param set The set
+ * @param oid The object id
+ * @param path The path of the tree that contains the object. The
+ * set keeps the pointer.
+ * @param name The name of the object, or NULL. The set keeps the
+ * pointer.
+ * @return 0 or error code
+ */
+static int
+git2r_odb_path_set_insert(
+    git2r_odb_path_set *set,
+    const git_oid *oid,
+    const char *path,
+    const char *name)
+{
+    size_t i, slot;
+    size_t hash = git2r_odb_path_key_hash(oid, path, name);
+
+    /* Keep the load factor of the hash table below 1/2. */
+    if (2 * (set->n + 1) > set->n_slots) {
+        size_t n_slots = set->n_slots ? 2 * set->n_slots : 1024;
+        git2r_odb_path_key *keys = calloc(n_slots, sizeof(git2r_odb_path_key));
+        if (!keys) {
+            giterr_set_oom();
+            return GIT_ERROR_NOMEMORY;
+        }
+        for (i = 0; i < set->n_slots; i++) {
+            if (!set->keys[i].path)
+                continue;
+            slot = set->keys[i].hash & (n_slots - 1);
+            while (keys[slot].path)
+                slot = (slot + 1) & (n_slots - 1);
+            keys[slot] = set->keys[i];
+        }
+        free(set->keys);
+        set->keys = keys;
+        set->n_slots = n_slots;
+    }
+
+    slot = git2r_odb_path_set_slot(set, oid, path, name, hash);
+    git_oid_cpy(&set->keys[slot].oid, oid);
+    set->keys[slot].path = path;
+    set->keys[slot].name = name;
+    set->keys[slot].hash = hash;
+    set->n++;
 
     return GIT_OK;
 }
 
 /**
- * Recursively iterate over all tree's
+ * A blob to add to the list.
+ */
+typedef struct {
+    const git2r_odb_tree_item *item;
+    const char *path;
+} git2r_odb_blob_row;
+
+/**
+ * Data structure to hold information when collecting the blobs of
+ * the commits.
+ */
+typedef struct {
+    git2r_odb_path_set trees;
+    git2r_odb_path_set blobs;
+    char **paths;
+    size_t n_paths;
+    size_t paths_size;
+    git2r_odb_blob_row *rows;
+    size_t n_rows;
+    size_t rows_size;
+    char *buf;
+    size_t buf_size;
+} git2r_odb_blobs_data;
+
+/**
+ * Recursively collect the blobs of a cached tree that have not been
+ * listed before at the same path. A sub-tree that has already been
+ * visited at the same path is skipped, since all of its blobs have
+ * been listed.
  *
- * @param tree The tree to iterate over
- * @param path The path to the tree relative to the repository workdir
- * @param commit The commit that contains the root tree of the iteration
- * @param author The author of the commit
- * @param when Time of the commit
- * @param data The callback data when iterating over odb objects
+ * @param cache The tree cache
+ * @param node The index of the node of the tree
+ * @param path_len The length of the path to the tree relative to
+ * the repository workdir, that is in data->buf.
+ * @param data The collected blobs
  * @return 0 or error code
  */
 static int
 git2r_odb_tree_blobs(
-    const git_tree *tree,
-    const char *path,
-    const char *commit,
-    const char *author,
-    double when,
-    git2r_odb_blobs_cb_data *data)
+    const git2r_odb_tree_cache *cache,
+    size_t node,
+    size_t path_len,
+    git2r_odb_blobs_data *data)
 {
     int error;
-    size_t i, n;
+    size_t i;
+    char *path;
+    const git2r_odb_tree_node *tree = &cache->nodes[node];
+
+    if (git2r_odb_path_set_contains(&data->trees, &tree->oid, data->buf, NULL))
+        return GIT_OK;
+
+    /* Keep a copy of the path, it's used by the keys and the rows. */
+    if (data->n_paths == data->paths_size) {
+        size_t size = data->paths_size ? 2 * data->paths_size : 1024;
+        char **paths = realloc(data->paths, size * sizeof(char*));
+        if (!paths)
+            goto oom;
+        data->paths = paths;
+        data->paths_size = size;
+    }
+    path = malloc(path_len + 1);
+    if (!path)
+        goto oom;
+    memcpy(path, data->buf, path_len);
+    path[path_len] = '\0';
+    data->paths[data->n_paths++] = path;
+
+    error = git2r_odb_path_set_insert(&data->trees, &tree->oid, path, NULL);
+    if (error)
+        return error;
 
-    n = git_tree_entrycount(tree);
-    for (i = 0; i < n; ++i) {
-        const git_tree_entry *entry;
+    for (i = 0; i < tree->n_items; i++) {
+        const git2r_odb_tree_item *item = &tree->items[i];
 
-        entry = git_tree_entry_byindex(tree, i);
-        switch (git_tree_entry_type(entry)) {
-        case GIT_OBJECT_TREE:
-        {
-            char *buf = NULL;
-            size_t path_len, buf_len;
-            const char *entry_name;
-            const char *sep;
-            git_tree *sub_tree = NULL;
-
-            error = git_tree_lookup(
-                &sub_tree,
-                data->repository,
-                git_tree_entry_id(entry));
-            if (error)
-                return error;
+        if (item->is_tree) {
+            size_t len = path_len + strlen(item->name) + (path_len ? 1 : 0);
 
-            entry_name = git_tree_entry_name(entry);
-            path_len = strlen(path);
-            buf_len = path_len + strlen(entry_name) + 2;
-            buf = malloc(buf_len);
-            if (!buf) {
-                git_tree_free(sub_tree);
-                giterr_set_oom();
-                return GIT_ERROR_NOMEMORY;
-            }
-            if (path_len) {
-                sep = "/";
-            } else {
-                sep = "";
-            }
-            error = snprintf(buf, buf_len, "%s%s%s", path, sep, entry_name);
-            if (0 <= error && (size_t)error < buf_len) {
-                error = git2r_odb_tree_blobs(
-                    sub_tree,
-                    buf,
-                    commit,
-                    author,
-                    when,
-                    data);
-            } else {
-                giterr_set_str(GIT_ERROR_OS, "Failed to snprintf tree path.");
-                error = GIT_ERROR_OS;
+            if (len + 1 > data->buf_size) {
+                size_t size = 2 * (len + 1);
+                char *buf = realloc(data->buf, size);
+                if (!buf)
+                    goto oom;
+                data->buf = buf;
+                data->buf_size = size;
             }
 
-            free(buf);
-            git_tree_free(sub_tree);
+            if (path_len)
+                data->buf[path_len] = '/';
+            strcpy(data->buf + path_len + (path_len ? 1 : 0), item->name);
 
+            error = git2r_odb_tree_blobs(cache, item->len, len, data);
             if (error)
                 return error;
-
-            break;
+            continue;
         }
-        case GIT_OBJECT_BLOB:
-            if (!Rf_isNull(data->list)) {
-                error = git2r_odb_add_blob(
-                    entry,
-                    data->odb,
-                    data->list,
-                    data->n,
-                    path,
-                    commit,
-                    author,
-                    when);
-                if (error)
-                    return error;
-            }
-            data->n += 1;
-            break;
-        default:
-            break;
+
+        if (git2r_odb_path_set_contains(&data->blobs, &item->oid, path, item->name))
+            continue;
+        error = git2r_odb_path_set_insert(&data->blobs, &item->oid, path, item->name);
+        if (error)
+            return error;
+
+        if (data->n_rows == data->rows_size) {
+            size_t size = data->rows_size ? 2 * data->rows_size : 1024;
+            git2r_odb_blob_row *rows =
+                realloc(data->rows, size * sizeof(git2r_odb_blob_row));
+            if (!rows)
+                goto oom;
+            data->rows = rows;
+            data->rows_size = size;
         }
+        data->rows[data->n_rows].item = item;
+        data->rows[data->n_rows].path = path;
+        data->n_rows++;
     }
 
     return GIT_OK;
+
+oom:
+    giterr_set_oom();
+    return GIT_ERROR_NOMEMORY;
+}
+
+/**
+ * A commit in the object database.
+ */
+typedef struct {
+    git_oid oid;
+    double when;
+    size_t index;
+    size_t tree;
+    size_t n_rows;
+} git2r_odb_commit;
+
+/**
+ * Order commits by the time of the author signature, and by the
+ * order in the object database for commits with the same time.
+ */
+static int
+git2r_odb_commit_cmp(
+    const void *a,
+    const void *b)
+{
+    const git2r_odb_commit *x = (const git2r_odb_commit*)a;
+    const git2r_odb_commit *y = (const git2r_odb_commit*)b;
+
+    if (x->when < y->when)
+        return -1;
+    if (x->when > y->when)
+        return 1;
+    if (x->index < y->index)
+        return -1;
+    return x->index > y->index;
 }
 
 /**
- * Callback when iterating over blobs
+ * Data structure to hold information when iterating over objects.
+ */
+typedef struct {
+    git_odb *odb;
+    git2r_oid_array commits;
+} git2r_odb_commits_cb_data;
+
+/**
+ * Callback when iterating over objects to collect the commits
  *
  * @param oid Oid of the object
  * @param payload Payload data
  * @return int 0 or error code
  */
 static int
-git2r_odb_blobs_cb(
+git2r_odb_commits_cb(
     const git_oid *oid,
     void *payload)
 {
-    int error = GIT_OK;
+    int error;
     size_t len;
     git_object_t type;
-    git2r_odb_blobs_cb_data *p = (git2r_odb_blobs_cb_data*)payload;
+    git2r_odb_commits_cb_data *p = (git2r_odb_commits_cb_data*)payload;
 
     error = git_odb_read_header(&len, &type, p->odb, oid);
     if (error)
         return error;
 
-    if (type == GIT_OBJECT_COMMIT) {
-        const git_signature *author;
-        git_commit *commit = NULL;
-        git_tree *tree = NULL;
-        char sha[GIT_OID_HEXSZ + 1];
-
-        error = git_commit_lookup(&commit, p->repository, oid);
-        if (error)
-            goto cleanup;
-
-        error = git_commit_tree(&tree, commit);
-        if (error)
-            goto cleanup;
-
-        git_oid_fmt(sha, oid);
-        sha[GIT_OID_HEXSZ] = '\0';
-
-        author = git_commit_author(commit);
-
-        /* Recursively iterate over all tree's */
-        error = git2r_odb_tree_blobs(
-            tree,
-            "",
-            sha,
-            author->name,
-            (double)(author->when.time),
-            p);
-
-    cleanup:
-        git_commit_free(commit);
-        git_tree_free(tree);
-    }
+    if (type == GIT_OBJECT_COMMIT)
+        return git2r_oid_array_push(&p->commits, oid);
 
-    return error;
+    return 0;
 }
 
 /**
  * List all blobs available in the database
  *
  * List all blobs reachable from the commits in the object
- * database. First list all commits. Then iterate over each blob from
- * the tree and sub-trees of each commit.
+ * database. First list all commits and read the tree of each commit
+ * into a cache, where every distinct tree is read once. Then, in the
+ * order of the author time of the commits, list each blob once for
+ * every path where it occurs, with the first commit that contains
+ * it at that path. Sub-trees that have already been visited at the
+ * same path are skipped, so the cost is proportional to the number
+ * of distinct trees rather than the number of commits.
  * @param repo S3 class git_repository
  * @return A list with blob entries
  */
@@ -508,12 +1189,18 @@ git2r_odb_blobs(
 {
     const char *names[] = {"sha", "path", "name", "len",
                            "commit", "author", "when", ""};
-    int i, error, nprotect = 0;
+    int error, nprotect = 0;
+    size_t i, j, k = 0;
     SEXP result = R_NilValue;
-    git2r_odb_blobs_cb_data cb_data = {0, R_NilValue, NULL, NULL};
+    git2r_odb_commits_cb_data cb_data = {NULL, GIT2R_OID_ARRAY_INIT};
+    git2r_odb_tree_cache cache = {NULL, NULL, NULL, 0, 0, NULL, 0};
+    git2r_odb_blobs_data data;
+    git2r_odb_commit *commits = NULL;
     git_odb *odb = NULL;
     git_repository *repository = NULL;
 
+    memset(&data, 0, sizeof(data));
+
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -522,30 +1209,122 @@ git2r_odb_blobs(
     if (error)
         goto cleanup;
     cb_data.odb = odb;
+    cache.repository = repository;
+    cache.odb = odb;
 
-    /* Count number of blobs before creating the list */
-    cb_data.repository = repository;
-    error = git_odb_foreach(odb, &git2r_odb_blobs_cb, &cb_data);
+    error = git_odb_foreach(odb, &git2r_odb_commits_cb, &cb_data);
     if (error)
         goto cleanup;
 
+    /* Read the tree of each commit into the cache. */
+    if (cb_data.commits.n) {
+        commits = calloc(cb_data.commits.n, sizeof(git2r_odb_commit));
+        if (!commits) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+    }
+    for (i = 0; i < cb_data.commits.n; i++) {
+        git_commit *commit = NULL;
+
+        error = git_commit_lookup(&commit, repository, &cb_data.commits.oids[i]);
+        if (error)
+            goto cleanup;
+        git_oid_cpy(&commits[i].oid, &cb_data.commits.oids[i]);
+        commits[i].when = (double)(git_commit_author(commit)->when.time);
+        commits[i].index = i;
+        error = git2r_odb_tree_cache_get(&commits[i].tree, &cache,
+                                         git_commit_tree_id(commit));
+        git_commit_free(commit);
+        if (error)
+            goto cleanup;
+    }
+
+    /* Collect the blobs that have not been listed at the same path
+     * by an earlier commit. */
+    if (cb_data.commits.n)
+        qsort(commits, cb_data.commits.n, sizeof(git2r_odb_commit),
+              git2r_odb_commit_cmp);
+    data.buf_size = 256;
+    data.buf = malloc(data.buf_size);
+    if (!data.buf) {
+        giterr_set_oom();
+        error = GIT_ERROR_NOMEMORY;
+        goto cleanup;
+    }
+    data.buf[0] = '\0';
+    for (i = 0; i < cb_data.commits.n; i++) {
+        size_t n_rows = data.n_rows;
+        data.buf[0] = '\0';
+        error = git2r_odb_tree_blobs(&cache, commits[i].tree, 0, &data);
+        if (error)
+            goto cleanup;
+        commits[i].n_rows = data.n_rows - n_rows;
+    }
+
     PROTECT(result = Rf_mkNamed(VECSXP, names));
     nprotect++;
-    i = 0;
-    SET_VECTOR_ELT(result, i++, Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i++, Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i++, Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i++, Rf_allocVector(INTSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i++, Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i++, Rf_allocVector(STRSXP,  cb_data.n));
-    SET_VECTOR_ELT(result, i, Rf_allocVector(REALSXP, cb_data.n));
-
-    cb_data.list = result;
-    cb_data.n = 0;
-    error = git_odb_foreach(odb, &git2r_odb_blobs_cb, &cb_data);
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP,  data.n_rows));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP,  data.n_rows));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(STRSXP,  data.n_rows));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(INTSXP,  data.n_rows));
+    SET_VECTOR_ELT(result, 4, Rf_allocVector(STRSXP,  data.n_rows));
+    SET_VECTOR_ELT(result, 5, Rf_allocVector(STRSXP,  data.n_rows));
+    SET_VECTOR_ELT(result, 6, Rf_allocVector(REALSXP, data.n_rows));
+
+    for (i = 0; i < cb_data.commits.n; i++) {
+        git_commit *commit = NULL;
+        char sha[GIT_OID_HEXSZ + 1];
+        SEXP commit_sha, author;
+
+        if (!commits[i].n_rows)
+            continue;
+
+        error = git_commit_lookup(&commit, repository, &commits[i].oid);
+        if (error)
+            goto cleanup;
+        git_oid_fmt(sha, &commits[i].oid);
+        sha[GIT_OID_HEXSZ] = '\0';
+        PROTECT(commit_sha = Rf_mkChar(sha));
+        PROTECT(author = Rf_mkChar(git_commit_author(commit)->name));
+        git_commit_free(commit);
+
+        for (j = 0; j < commits[i].n_rows; j++, k++) {
+            const git2r_odb_blob_row *row = &data.rows[k];
+
+            /* Consecutive blobs in the same tree share the path. */
+            if (k && row->path == data.rows[k - 1].path) {
+                SET_STRING_ELT(VECTOR_ELT(result, 1), k,
+                               STRING_ELT(VECTOR_ELT(result, 1), k - 1));
+            } else {
+                SET_STRING_ELT(VECTOR_ELT(result, 1), k, Rf_mkChar(row->path));
+            }
+
+            git_oid_fmt(sha, &row->item->oid);
+            SET_STRING_ELT(VECTOR_ELT(result, 0), k, Rf_mkChar(sha));
+            SET_STRING_ELT(VECTOR_ELT(result, 2), k, Rf_mkChar(row->item->name));
+            INTEGER(VECTOR_ELT(result, 3))[k] = (int)row->item->len;
+            SET_STRING_ELT(VECTOR_ELT(result, 4), k, commit_sha);
+            SET_STRING_ELT(VECTOR_ELT(result, 5), k, author);
+            REAL(VECTOR_ELT(result, 6))[k] = commits[i].when;
+        }
+
+        UNPROTECT(2);
+    }
 
 cleanup:
-    git_repository_free(repository);
+    for (i = 0; i < data.n_paths; i++)
+        free(data.paths[i]);
+    free(data.paths);
+    free(data.trees.keys);
+    free(data.blobs.keys);
+    free(data.rows);
+    free(data.buf);
+    free(commits);
+    git2r_odb_tree_cache_free(&cache);
+    git2r_oid_array_free(&cb_data.commits);
+    git2r_repository_close(repository);
     git_odb_free(odb);
 
     if (nprotect)
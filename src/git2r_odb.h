@@ -24,7 +24,11 @@
 
 SEXP git2r_odb_blobs(SEXP repo);
 SEXP git2r_odb_hash(SEXP data);
-SEXP git2r_odb_hashfile(SEXP path);
-SEXP git2r_odb_objects(SEXP repo);
+SEXP git2r_odb_hash_final(SEXP ctx);
+SEXP git2r_odb_hash_init(SEXP size);
+SEXP git2r_odb_hash_raw(SEXP data);
+SEXP git2r_odb_hash_update(SEXP ctx, SEXP data);
+SEXP git2r_odb_hashfile(SEXP path, SEXP nthreads);
+SEXP git2r_odb_objects(SEXP repo, SEXP type, SEXP header, SEXP oid_vector);
 
 #endif
@@ -1,6 +1,6 @@
 /*
  *  git2r, R bindings to the libgit2 library.
- *  Copyright (C) 2013-2020 The git2r contributors
+ *  Copyright (C) 2013-2026 The git2r contributors
  *
  *  This program is free software; you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License, version 2,
@@ -17,13 +17,19 @@
  */
 
 #include <R_ext/Visibility.h>
+#include "git2r_arg.h"
+#include "git2r_error.h"
 #include "git2r_oid.h"
+#include "git2r_S3.h"
+
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * Get oid from sha SEXP
  *
  * @param sha A character vector with sha's. The length
- * can be less than 40 bytes.
+ * can be less than 40 bytes. Can also be a git_oid_vector.
  * @param oid result is written into the oid
  * @return void
  */
@@ -34,9 +40,341 @@ git2r_oid_from_sha_sexp(
 {
     size_t len;
 
+    if (TYPEOF(sha) == RAWSXP) {
+        git2r_oid_vector_get(sha, 0, oid);
+        return;
+    }
+
     len = LENGTH(STRING_ELT(sha, 0));
     if (GIT_OID_HEXSZ == len)
         git_oid_fromstr(oid, CHAR(STRING_ELT(sha, 0)));
     else
         git_oid_fromstrn(oid, CHAR(STRING_ELT(sha, 0)), len);
 }
+
+/**
+ * Append an oid to a growable array of oids
+ *
+ * @param array The array to append the oid to.
+ * @param oid The oid to append.
+ * @return 0 on success, or GIT_ERROR_NOMEMORY if the array could not
+ * be grown.
+ */
+int attribute_hidden
+git2r_oid_array_push(
+    git2r_oid_array *array,
+    const git_oid *oid)
+{
+    if (array->n == array->size) {
+        size_t size = array->size ? 2 * array->size : 1024;
+        git_oid *oids = realloc(array->oids, size * sizeof(git_oid));
+        if (!oids) {
+            giterr_set_oom();
+            return GIT_ERROR_NOMEMORY;
+        }
+        array->oids = oids;
+        array->size = size;
+    }
+
+    git_oid_cpy(&array->oids[array->n++], oid);
+
+    return 0;
+}
+
+/**
+ * Free the memory of a growable array of oids
+ *
+ * @param array The array to free.
+ * @return void
+ */
+void attribute_hidden
+git2r_oid_array_free(
+    git2r_oid_array *array)
+{
+    free(array->oids);
+    array->oids = NULL;
+    array->n = 0;
+    array->size = 0;
+}
+
+/**
+ * Allocate a git_oid_vector, the compact vector of oids with the raw
+ * 20-byte oids stored after each other in a raw vector.
+ *
+ * @param n The number of oids.
+ * @return An unprotected git_oid_vector where all oids are zero.
+ */
+SEXP attribute_hidden
+git2r_oid_vector_alloc(
+    R_xlen_t n)
+{
+    SEXP x;
+
+    PROTECT(x = Rf_allocVector(RAWSXP, n * GIT_OID_RAWSZ));
+    memset(RAW(x), 0, n * GIT_OID_RAWSZ);
+    Rf_setAttrib(x, R_ClassSymbol, Rf_mkString(git2r_S3_class__git_oid_vector));
+    UNPROTECT(1);
+
+    return x;
+}
+
+/**
+ * Get an oid from a git_oid_vector
+ *
+ * @param x The git_oid_vector.
+ * @param i The zero-based index of the oid.
+ * @param oid result is written into the oid
+ * @return void
+ */
+void attribute_hidden
+git2r_oid_vector_get(
+    SEXP x,
+    R_xlen_t i,
+    git_oid *oid)
+{
+    git_oid_fromraw(oid, RAW(x) + i * GIT_OID_RAWSZ);
+}
+
+/**
+ * Set an oid in a git_oid_vector, or in a raw vector that is grown
+ * before it is made into a git_oid_vector.
+ *
+ * @param x The git_oid_vector.
+ * @param i The zero-based index of the oid.
+ * @param oid The oid to set, or NULL for the zero oid that is
+ * formatted as NA.
+ * @return void
+ */
+void attribute_hidden
+git2r_oid_vector_set(
+    SEXP x,
+    R_xlen_t i,
+    const git_oid *oid)
+{
+    if (oid)
+        memcpy(RAW(x) + i * GIT_OID_RAWSZ, oid->id, GIT_OID_RAWSZ);
+    else
+        memset(RAW(x) + i * GIT_OID_RAWSZ, 0, GIT_OID_RAWSZ);
+}
+
+/**
+ * Parse a character vector with sha's into a git_oid_vector
+ *
+ * @param sha A character vector with 40 character sha's. NA is
+ * parsed to the zero oid.
+ * @return A git_oid_vector
+ */
+SEXP attribute_hidden
+git2r_oid_vector_parse(
+    SEXP sha)
+{
+    SEXP result;
+    R_xlen_t i, n;
+
+    if (git2r_arg_check_string_vec(sha))
+        git2r_error(__func__, NULL, "'sha'", git2r_err_string_vec_arg);
+
+    n = Rf_xlength(sha);
+    PROTECT(result = git2r_oid_vector_alloc(n));
+    for (i = 0; i < n; i++) {
+        git_oid oid;
+        SEXP elt = STRING_ELT(sha, i);
+
+        if (elt == NA_STRING)
+            continue;
+        if (LENGTH(elt) != GIT_OID_HEXSZ || git_oid_fromstr(&oid, CHAR(elt)))
+            git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
+        git2r_oid_vector_set(result, i, &oid);
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Format a git_oid_vector as a character vector with sha's
+ *
+ * @param x The git_oid_vector.
+ * @return A character vector with 40 character sha's, where the
+ * zero oid is NA.
+ */
+SEXP attribute_hidden
+git2r_oid_vector_format(
+    SEXP x)
+{
+    SEXP result;
+    R_xlen_t i, n;
+
+    if (git2r_arg_check_oid_vector(x))
+        git2r_error(__func__, NULL, "'x'", git2r_err_oid_vector_arg);
+
+    n = Rf_xlength(x) / GIT_OID_RAWSZ;
+    PROTECT(result = Rf_allocVector(STRSXP, n));
+    for (i = 0; i < n; i++) {
+        char hex[GIT_OID_HEXSZ + 1];
+        git_oid oid;
+
+        git2r_oid_vector_get(x, i, &oid);
+        if (git_oid_is_zero(&oid)) {
+            SET_STRING_ELT(result, i, NA_STRING);
+        } else {
+            git_oid_tostr(hex, sizeof(hex), &oid);
+            SET_STRING_ELT(result, i, Rf_mkChar(hex));
+        }
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Hash set with the indices of the oids in a git_oid_vector. The
+ * oids are uniformly distributed, so the first bytes of the oid are
+ * used as the hash.
+ */
+typedef struct {
+    const unsigned char *raw;
+    R_xlen_t *slots; /* One-based index, or 0 for an empty slot. */
+    size_t mask;
+} git2r_oid_set;
+
+static int
+git2r_oid_set_init(
+    git2r_oid_set *set,
+    SEXP x)
+{
+    size_t size = 16, n = Rf_xlength(x) / GIT_OID_RAWSZ;
+
+    while (size < 2 * n)
+        size *= 2;
+
+    set->raw = RAW(x);
+    set->mask = size - 1;
+    set->slots = calloc(size, sizeof(R_xlen_t));
+    if (!set->slots)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Find the slot of an oid in the set
+ *
+ * @param set The set.
+ * @param raw The raw 20-byte oid.
+ * @return The slot, which is empty if the oid is not in the set.
+ */
+static R_xlen_t*
+git2r_oid_set_slot(
+    const git2r_oid_set *set,
+    const unsigned char *raw)
+{
+    size_t h;
+
+    memcpy(&h, raw, sizeof(h));
+    for (h &= set->mask;; h = (h + 1) & set->mask) {
+        R_xlen_t *slot = &set->slots[h];
+
+        if (!*slot ||
+            !memcmp(set->raw + (*slot - 1) * GIT_OID_RAWSZ, raw, GIT_OID_RAWSZ))
+            return slot;
+    }
+}
+
+/**
+ * Match the oids in a git_oid_vector against a table of oids
+ *
+ * @param x The git_oid_vector with the oids to match.
+ * @param table The git_oid_vector with the oids to match against.
+ * @return An integer vector with the one-based positions of the first
+ * match in table, or NA if there is no match.
+ */
+SEXP attribute_hidden
+git2r_oid_vector_match(
+    SEXP x,
+    SEXP table)
+{
+    SEXP result;
+    R_xlen_t i, n;
+    git2r_oid_set set;
+
+    if (git2r_arg_check_oid_vector(x))
+        git2r_error(__func__, NULL, "'x'", git2r_err_oid_vector_arg);
+    if (git2r_arg_check_oid_vector(table))
+        git2r_error(__func__, NULL, "'table'", git2r_err_oid_vector_arg);
+
+    /* Allocate the result before the set, since an R error in the
+     * allocation would leak the set. */
+    n = Rf_xlength(x) / GIT_OID_RAWSZ;
+    PROTECT(result = Rf_allocVector(INTSXP, n));
+
+    if (git2r_oid_set_init(&set, table)) {
+        UNPROTECT(1);
+        git2r_error(__func__, NULL, git2r_err_alloc_memory_buffer, NULL);
+    }
+
+    n = Rf_xlength(table) / GIT_OID_RAWSZ;
+    for (i = 0; i < n; i++) {
+        R_xlen_t *slot = git2r_oid_set_slot(&set, set.raw + i * GIT_OID_RAWSZ);
+        if (!*slot)
+            *slot = i + 1;
+    }
+
+    n = Rf_xlength(x) / GIT_OID_RAWSZ;
+    for (i = 0; i < n; i++) {
+        R_xlen_t *slot = git2r_oid_set_slot(&set, RAW(x) + i * GIT_OID_RAWSZ);
+        INTEGER(result)[i] = *slot ? (int)*slot : NA_INTEGER;
+    }
+
+    free(set.slots);
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Determine the duplicated oids in a git_oid_vector
+ *
+ * @param x The git_oid_vector.
+ * @return A logical vector that is TRUE for an oid that is equal to
+ * an oid with a lower index.
+ */
+SEXP attribute_hidden
+git2r_oid_vector_duplicated(
+    SEXP x)
+{
+    SEXP result;
+    R_xlen_t i, n;
+    git2r_oid_set set;
+
+    if (git2r_arg_check_oid_vector(x))
+        git2r_error(__func__, NULL, "'x'", git2r_err_oid_vector_arg);
+
+    /* Allocate the result before the set, since an R error in the
+     * allocation would leak the set. */
+    n = Rf_xlength(x) / GIT_OID_RAWSZ;
+    PROTECT(result = Rf_allocVector(LGLSXP, n));
+
+    if (git2r_oid_set_init(&set, x)) {
+        UNPROTECT(1);
+        git2r_error(__func__, NULL, git2r_err_alloc_memory_buffer, NULL);
+    }
+
+    for (i = 0; i < n; i++) {
+        R_xlen_t *slot = git2r_oid_set_slot(&set, set.raw + i * GIT_OID_RAWSZ);
+
+        if (*slot) {
+            LOGICAL(result)[i] = 1;
+        } else {
+            LOGICAL(result)[i] = 0;
+            *slot = i + 1;
+        }
+    }
+
+    free(set.slots);
+    UNPROTECT(1);
+
+    return result;
+}
@@ -1,6 +1,6 @@
 /*
  *  git2r, R bindings to the libgit2 library.
- *  Copyright (C) 2013-2015 The git2r contributors
+ *  Copyright (C) 2013-2026 The git2r contributors
  *
  *  This program is free software; you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License, version 2,
@@ -23,6 +23,27 @@
 #include <Rinternals.h>
 #include <git2.h>
 
+/**
+ * Growable array of oids.
+ */
+typedef struct {
+    git_oid *oids;
+    size_t n;
+    size_t size;
+} git2r_oid_array;
+
+#define GIT2R_OID_ARRAY_INIT {NULL, 0, 0}
+
 void git2r_oid_from_sha_sexp(SEXP sha, git_oid *oid);
+int git2r_oid_array_push(git2r_oid_array *array, const git_oid *oid);
+void git2r_oid_array_free(git2r_oid_array *array);
+
+SEXP git2r_oid_vector_alloc(R_xlen_t n);
+void git2r_oid_vector_get(SEXP x, R_xlen_t i, git_oid *oid);
+void git2r_oid_vector_set(SEXP x, R_xlen_t i, const git_oid *oid);
+SEXP git2r_oid_vector_duplicated(SEXP x);
+SEXP git2r_oid_vector_format(SEXP x);
+SEXP git2r_oid_vector_match(SEXP x, SEXP table);
+SEXP git2r_oid_vector_parse(SEXP sha);
 
 #endif
@@ -128,7 +128,7 @@ cleanup:
         git_remote_free(remote);
     }
 
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(
@@ -30,9 +30,261 @@
 #include "git2r_tag.h"
 #include "git2r_tree.h"
 
+/**
+ * An entry in the cache with open repository handles.
+ */
+typedef struct {
+    char *path;
+    git_repository *repository;
+    unsigned long last_used;
+    int refcount;
+} git2r_repository_cache_entry;
+
+/**
+ * Session-scoped cache with open repository handles keyed by the
+ * normalized path of the repository. The cache is disabled when
+ * 'limit' is zero, which is the default. When the cache is full, the
+ * least recently used handle that is not in use is evicted.
+ *
+ * A handle can be in use across calls from R, e.g. by a blob
+ * reader. When such a handle is removed from the cache, it is moved
+ * to 'detached' and freed by 'git2r_repository_close' when it is no
+ * longer in use.
+ */
+static struct {
+    git2r_repository_cache_entry *entries;
+    size_t n;
+    size_t limit;
+    unsigned long tick;
+    double hits;
+    double misses;
+    git2r_repository_cache_entry *detached;
+    size_t n_detached;
+} git2r_repository_cache = {NULL, 0, 0, 0, 0.0, 0.0, NULL, 0};
+
+/**
+ * Length of a path without trailing path separators.
+ *
+ * @param path The path to the repository.
+ * @return The length of the normalized path.
+ */
+static size_t
+git2r_repository_cache_keylen(
+    const char *path)
+{
+    size_t len = strlen(path);
+
+    while (len > 1 && (path[len - 1] == '/' || path[len - 1] == '\\'))
+        len--;
+
+    return len;
+}
+
+/**
+ * Find the index of the cache entry for a path.
+ *
+ * @param path The path to the repository.
+ * @return The index of the entry, or -1 if not in the cache.
+ */
+static int
+git2r_repository_cache_find(
+    const char *path)
+{
+    size_t i, len = git2r_repository_cache_keylen(path);
+
+    for (i = 0; i < git2r_repository_cache.n; i++) {
+        const char *key = git2r_repository_cache.entries[i].path;
+        if (strlen(key) == len && !strncmp(key, path, len))
+            return (int)i;
+    }
+
+    return -1;
+}
+
+/**
+ * Remove an entry from the cache and free the repository handle. A
+ * handle that is in use is detached from the cache instead, and is
+ * freed when the last user closes it.
+ *
+ * @param i The index of the entry to remove.
+ */
+static void
+git2r_repository_cache_remove(
+    size_t i)
+{
+    git2r_repository_cache_entry *entries = git2r_repository_cache.entries;
+
+    if (entries[i].refcount > 0) {
+        git2r_repository_cache_entry *detached = realloc(
+            git2r_repository_cache.detached,
+            (git2r_repository_cache.n_detached + 1) * sizeof(*detached));
+
+        /* Leak the handle rather than free it while in use. */
+        if (detached) {
+            git2r_repository_cache.detached = detached;
+            detached[git2r_repository_cache.n_detached++] = entries[i];
+            detached[git2r_repository_cache.n_detached - 1].path = NULL;
+        }
+    } else {
+        git_repository_free(entries[i].repository);
+    }
+    free(entries[i].path);
+    git2r_repository_cache.n--;
+    if (i < git2r_repository_cache.n) {
+        memmove(&entries[i], &entries[i + 1],
+                (git2r_repository_cache.n - i) * sizeof(*entries));
+    }
+}
+
+/**
+ * Remove the least recently used entries that are not in use until
+ * there are at most 'n' entries in the cache.
+ *
+ * @param n The number of entries to keep.
+ * @return 0 if the cache has at most 'n' entries, else -1.
+ */
+static int
+git2r_repository_cache_evict(
+    size_t n)
+{
+    while (git2r_repository_cache.n > n) {
+        size_t i;
+        int lru = -1;
+
+        for (i = 0; i < git2r_repository_cache.n; i++) {
+            git2r_repository_cache_entry *entry =
+                &git2r_repository_cache.entries[i];
+            if (entry->refcount > 0)
+                continue;
+            if (lru < 0 ||
+                entry->last_used < git2r_repository_cache.entries[lru].last_used)
+                lru = (int)i;
+        }
+
+        if (lru < 0)
+            return -1;
+        git2r_repository_cache_remove(lru);
+    }
+
+    return 0;
+}
+
+/**
+ * Get a cached repository handle.
+ *
+ * Re-read the index if it has been changed on disk since the handle
+ * was opened, e.g. by a git command line client.
+ *
+ * @param path The path to the repository.
+ * @return The repository handle, or NULL if not in the cache.
+ */
+static git_repository*
+git2r_repository_cache_get(
+    const char *path)
+{
+    int i = git2r_repository_cache_find(path);
+    git2r_repository_cache_entry *entry;
+
+    if (i < 0) {
+        git2r_repository_cache.misses++;
+        return NULL;
+    }
+
+    entry = &git2r_repository_cache.entries[i];
+    entry->last_used = ++git2r_repository_cache.tick;
+    entry->refcount++;
+    git2r_repository_cache.hits++;
+
+    if (!git_repository_is_bare(entry->repository)) {
+        git_index *index = NULL;
+
+        if (!git_repository_index(&index, entry->repository))
+            git_index_read(index, 0);
+        git_index_free(index);
+    }
+
+    return entry->repository;
+}
+
+/**
+ * Add a repository handle to the cache.
+ *
+ * The handle is not cached if all entries in a full cache are in
+ * use, and is then freed by 'git2r_repository_close'.
+ *
+ * @param path The path to the repository.
+ * @param repository The repository handle.
+ */
+static void
+git2r_repository_cache_add(
+    const char *path,
+    git_repository *repository)
+{
+    size_t len = git2r_repository_cache_keylen(path);
+    git2r_repository_cache_entry *entry;
+    char *key;
+
+    if (git2r_repository_cache_evict(git2r_repository_cache.limit - 1))
+        return;
+
+    key = malloc(len + 1);
+    if (!key)
+        return;
+    memcpy(key, path, len);
+    key[len] = '\0';
+
+    entry = &git2r_repository_cache.entries[git2r_repository_cache.n++];
+    entry->path = key;
+    entry->repository = repository;
+    entry->last_used = ++git2r_repository_cache.tick;
+    entry->refcount = 1;
+}
+
+/**
+ * Remove a repository from the cache, for example, when a new
+ * repository is created or cloned at the path.
+ *
+ * @param path The path to the repository.
+ */
+void attribute_hidden
+git2r_repository_cache_invalidate(
+    const char *path)
+{
+    int i = git2r_repository_cache_find(path);
+
+    if (i >= 0)
+        git2r_repository_cache_remove(i);
+}
+
+/**
+ * Free all repository handles in the cache.
+ */
+void attribute_hidden
+git2r_repository_cache_free(void)
+{
+    size_t i;
+
+    for (i = 0; i < git2r_repository_cache.n; i++) {
+        git_repository_free(git2r_repository_cache.entries[i].repository);
+        free(git2r_repository_cache.entries[i].path);
+    }
+    for (i = 0; i < git2r_repository_cache.n_detached; i++)
+        git_repository_free(git2r_repository_cache.detached[i].repository);
+    free(git2r_repository_cache.entries);
+    free(git2r_repository_cache.detached);
+    git2r_repository_cache.entries = NULL;
+    git2r_repository_cache.detached = NULL;
+    git2r_repository_cache.n = 0;
+    git2r_repository_cache.n_detached = 0;
+    git2r_repository_cache.limit = 0;
+}
+
 /**
  * Get repo from S3 class git_repository
  *
+ * The repository handle must be released with
+ * 'git2r_repository_close'.
+ *
  * @param repo S3 class git_repository
  * @return a git_repository pointer on success else NULL
  */
@@ -50,6 +302,13 @@ git2r_repository_open(
     }
 
     path = git2r_get_list_element(repo, "path");
+
+    if (git2r_repository_cache.limit) {
+        repository = git2r_repository_cache_get(CHAR(STRING_ELT(path, 0)));
+        if (repository)
+            return repository;
+    }
+
     error = git_repository_open(&repository, CHAR(STRING_ELT(path, 0)));
     if (error) {
         if (error == GIT_ENOTFOUND)
@@ -60,9 +319,150 @@ git2r_repository_open(
         return NULL;
     }
 
+    if (git2r_repository_cache.limit)
+        git2r_repository_cache_add(CHAR(STRING_ELT(path, 0)), repository);
+
     return repository;
 }
 
+/**
+ * Release a repository handle from 'git2r_repository_open'
+ *
+ * A cached handle is kept open for the next call. A handle that has
+ * been detached from the cache is freed by its last user, and an
+ * uncached handle is freed.
+ *
+ * @param repository The repository handle. Can be NULL.
+ */
+void attribute_hidden
+git2r_repository_close(
+    git_repository *repository)
+{
+    size_t i;
+
+    if (!repository)
+        return;
+
+    for (i = 0; i < git2r_repository_cache.n; i++) {
+        git2r_repository_cache_entry *entry =
+            &git2r_repository_cache.entries[i];
+        if (entry->repository == repository) {
+            if (entry->refcount > 0)
+                entry->refcount--;
+            return;
+        }
+    }
+
+    for (i = 0; i < git2r_repository_cache.n_detached; i++) {
+        git2r_repository_cache_entry *entry =
+            &git2r_repository_cache.detached[i];
+        if (entry->repository == repository) {
+            if (--entry->refcount > 0)
+                return;
+            git2r_repository_cache.n_detached--;
+            if (i < git2r_repository_cache.n_detached) {
+                memmove(entry, entry + 1,
+                        (git2r_repository_cache.n_detached - i) * sizeof(*entry));
+            }
+            break;
+        }
+    }
+
+    git_repository_free(repository);
+}
+
+/**
+ * Set the maximum number of repository handles in the cache.
+ *
+ * @param size The maximum number of cached handles. Use zero to
+ * disable the cache and free all cached handles.
+ * @return The previous maximum number of cached handles.
+ */
+SEXP attribute_hidden
+git2r_repository_cache_size(
+    SEXP size)
+{
+    size_t limit;
+    git2r_repository_cache_entry *entries;
+    SEXP result;
+
+    if (git2r_arg_check_integer_gte_zero(size))
+        git2r_error(__func__, NULL, "'size'", git2r_err_integer_gte_zero_arg);
+
+    PROTECT(result = Rf_ScalarInteger((int)git2r_repository_cache.limit));
+
+    /* Evict the handles that are not in use first. The handles that
+     * are still in use are detached and freed by their last user. */
+    limit = INTEGER(size)[0];
+    git2r_repository_cache_evict(limit);
+    while (git2r_repository_cache.n > limit)
+        git2r_repository_cache_remove(git2r_repository_cache.n - 1);
+
+    if (!limit) {
+        free(git2r_repository_cache.entries);
+        git2r_repository_cache.entries = NULL;
+        git2r_repository_cache.limit = 0;
+    } else {
+        entries = realloc(git2r_repository_cache.entries,
+                          limit * sizeof(*entries));
+        if (!entries) {
+            UNPROTECT(1);
+            git2r_error(__func__, NULL, git2r_err_alloc_memory_buffer, NULL);
+        }
+        git2r_repository_cache.entries = entries;
+        git2r_repository_cache.limit = limit;
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Remove repository handles from the cache.
+ *
+ * @param repo S3 class git_repository, or R_NilValue to remove all
+ * repository handles.
+ * @return R_NilValue
+ */
+SEXP attribute_hidden
+git2r_repository_cache_clear(
+    SEXP repo)
+{
+    if (Rf_isNull(repo)) {
+        while (git2r_repository_cache.n)
+            git2r_repository_cache_remove(git2r_repository_cache.n - 1);
+    } else {
+        if (git2r_arg_check_repository(repo))
+            git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+        git2r_repository_cache_invalidate(
+            CHAR(STRING_ELT(git2r_get_list_element(repo, "path"), 0)));
+    }
+
+    return R_NilValue;
+}
+
+/**
+ * Get statistics of the repository cache.
+ *
+ * @return A list with the size, count, hits and misses of the cache.
+ */
+SEXP attribute_hidden
+git2r_repository_cache_stats(void)
+{
+    const char *names[] = {"size", "count", "hits", "misses", ""};
+    SEXP result;
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    SET_VECTOR_ELT(result, 0, Rf_ScalarInteger((int)git2r_repository_cache.limit));
+    SET_VECTOR_ELT(result, 1, Rf_ScalarInteger((int)git2r_repository_cache.n));
+    SET_VECTOR_ELT(result, 2, Rf_ScalarReal(git2r_repository_cache.hits));
+    SET_VECTOR_ELT(result, 3, Rf_ScalarReal(git2r_repository_cache.misses));
+    UNPROTECT(1);
+
+    return result;
+}
+
 /**
  * Data structure to hold information when iterating over FETCH_HEAD
  * entries.
@@ -182,7 +582,7 @@ git2r_repository_fetch_heads(
         &cb_data);
 
 cleanup:
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -248,7 +648,7 @@ git2r_repository_head(
 cleanup:
     git_commit_free(commit);
     git_reference_free(reference);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -299,6 +699,9 @@ git2r_repository_init(
     if (error)
         git2r_error(__func__, NULL, git2r_err_repo_init, NULL);
 
+    /* Drop stale handles to a previous repository at the path. */
+    git2r_repository_cache_invalidate(CHAR(STRING_ELT(path, 0)));
+    git2r_repository_cache_invalidate(git_repository_path(repository));
     git_repository_free(repository);
 
     return R_NilValue;
@@ -322,7 +725,7 @@ git2r_repository_is_bare(
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
     is_bare = git_repository_is_bare(repository);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
     if (is_bare < 0)
         git2r_error(__func__, git_error_last(), NULL, NULL);
     return Rf_ScalarLogical(is_bare);
@@ -346,7 +749,7 @@ git2r_repository_is_shallow(
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
     is_shallow = git_repository_is_shallow(repository);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
     if (is_shallow < 0)
         git2r_error(__func__, git_error_last(), NULL, NULL);
     return Rf_ScalarLogical(is_shallow);
@@ -370,7 +773,7 @@ git2r_repository_head_detached(
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
     head_detached = git_repository_head_detached(repository);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
     if (head_detached < 0)
         git2r_error(__func__, git_error_last(), NULL, NULL);
     return Rf_ScalarLogical(head_detached);
@@ -394,7 +797,7 @@ git2r_repository_is_empty(
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
     is_empty = git_repository_is_empty(repository);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
     if (is_empty < 0)
         git2r_error(__func__, git_error_last(), NULL, NULL);
     return Rf_ScalarLogical(is_empty);
@@ -450,7 +853,7 @@ git2r_repository_set_head(
 
     error = git_repository_set_head(repository, CHAR(STRING_ELT(ref_name, 0)));
 
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
@@ -496,7 +899,7 @@ git2r_repository_set_head_detached(
 
 cleanup:
     git_commit_free(treeish);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (error)
         git2r_error(__func__, git_error_last(), NULL, NULL);
@@ -530,7 +933,7 @@ git2r_repository_workdir(
         SET_STRING_ELT(result, 0, Rf_mkChar(wd));
     }
 
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
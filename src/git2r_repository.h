@@ -1,6 +1,6 @@
 /*
  *  git2r, R bindings to the libgit2 library.
- *  Copyright (C) 2013-2015 The git2r contributors
+ *  Copyright (C) 2013-2024 The git2r contributors
  *
  *  This program is free software; you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License, version 2,
@@ -25,6 +25,12 @@
 #include <git2.h>
 
 git_repository* git2r_repository_open(SEXP repo);
+void git2r_repository_close(git_repository *repository);
+void git2r_repository_cache_invalidate(const char *path);
+void git2r_repository_cache_free(void);
+SEXP git2r_repository_cache_clear(SEXP repo);
+SEXP git2r_repository_cache_size(SEXP size);
+SEXP git2r_repository_cache_stats(void);
 SEXP git2r_repository_can_open(SEXP path);
 SEXP git2r_repository_discover(SEXP path, SEXP ceiling);
 SEXP git2r_repository_fetch_heads(SEXP repo);
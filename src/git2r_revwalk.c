@@ -18,8 +18,11 @@
 
 #include <R_ext/Visibility.h>
 #include <git2.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "git2r_arg.h"
+#include "git2r_bloom.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
 #include "git2r_oid.h"
@@ -27,39 +30,189 @@
 #include "git2r_S3.h"
 
 /**
- * Count number of revisions.
+ * Walk the revisions and collect the commit ids.
  *
- * @param walker The walker to pop the commit from.
+ * @param out The array to append the commit ids to.
+ * @param walker The walker to pop the commits from.
  * @param max_n n The upper limit of the number of commits to
  * output. Use max_n < 0 for unlimited number of commits.
- * @return The number of revisions
+ * @return 0 on success, or an error code.
  */
 static int
-git2r_revwalk_count(
+git2r_revwalk_collect(
+    git2r_oid_array *out,
     git_revwalk *walker,
     int max_n)
 {
-    int n = 0;
+    int error;
     git_oid oid;
 
-    while (!git_revwalk_next(&oid, walker)) {
-        if (max_n < 0 || n < max_n)
-            n++;
-        else
+    while (max_n < 0 || out->n < (size_t)max_n) {
+        error = git_revwalk_next(&oid, walker);
+        if (error) {
+            if (GIT_ITEROVER == error)
+                error = GIT_OK;
+            return error;
+        }
+
+        error = git2r_oid_array_push(out, &oid);
+        if (error)
+            return error;
+    }
+
+    return GIT_OK;
+}
+
+/**
+ * Create a list with S3 class git_commit objects.
+ *
+ * @param out The list with the commits.
+ * @param oids The ids of the commits.
+ * @param repository The repository with the commits.
+ * @param repo S3 class git_repository that contains the commits.
+ * @return 0 on success, or an error code.
+ */
+static int
+git2r_revwalk_commit_list(
+    SEXP *out,
+    const git2r_oid_array *oids,
+    git_repository *repository,
+    SEXP repo)
+{
+    size_t i;
+    SEXP result;
+
+    PROTECT(result = Rf_allocVector(VECSXP, oids->n));
+
+    for (i = 0; i < oids->n; i++) {
+        int error;
+        git_commit *commit;
+        SEXP item;
+
+        error = git_commit_lookup(&commit, repository, &oids->oids[i]);
+        if (error) {
+            UNPROTECT(1);
+            return error;
+        }
+
+        SET_VECTOR_ELT(
+            result,
+            i,
+            item = Rf_mkNamed(VECSXP, git2r_S3_items__git_commit));
+        Rf_setAttrib(item, R_ClassSymbol,
+                     Rf_mkString(git2r_S3_class__git_commit));
+        git2r_commit_init(commit, repo, item);
+        git_commit_free(commit);
+    }
+
+    *out = result;
+    UNPROTECT(1);
+
+    return GIT_OK;
+}
+
+/**
+ * Check if a literal path differs between two trees by resolving the
+ * path component by component in both trees. The walk stops as soon
+ * as the subtrees on the path have the same id, so unchanged
+ * subtrees are never read.
+ *
+ * @param out 1 if the entry at the path, or any entry below it,
+ * differs between the trees, else 0.
+ * @param a The first tree.
+ * @param b The second tree.
+ * @param path The literal path.
+ * @return 0 on success, or an error code.
+ */
+static int
+git2r_match_tree_path(
+    int *out,
+    git_tree *a,
+    git_tree *b,
+    const char *path)
+{
+    int error = GIT_OK;
+    git_repository *repository = git_tree_owner(b);
+    git_tree *ta = a, *tb = b;
+    char *name = NULL;
+
+    *out = 0;
+
+    name = malloc(strlen(path) + 1);
+    if (!name) {
+        giterr_set_oom();
+        return GIT_ERROR_NOMEMORY;
+    }
+
+    for (;;) {
+        size_t len = strcspn(path, "/");
+        const git_tree_entry *ea = NULL, *eb = NULL;
+        git_tree *na = NULL, *nb = NULL;
+
+        if (ta && tb && git_oid_equal(git_tree_id(ta), git_tree_id(tb)))
+            break;
+
+        memcpy(name, path, len);
+        name[len] = '\0';
+        if (ta)
+            ea = git_tree_entry_byname(ta, name);
+        if (tb)
+            eb = git_tree_entry_byname(tb, name);
+        if (!ea && !eb)
+            break;
+
+        if (!path[len]) {
+            *out = !ea || !eb ||
+                !git_oid_equal(git_tree_entry_id(ea), git_tree_entry_id(eb)) ||
+                git_tree_entry_filemode(ea) != git_tree_entry_filemode(eb);
             break;
+        }
+
+        if (ea && git_tree_entry_type(ea) == GIT_OBJECT_TREE) {
+            error = git_tree_lookup(&na, repository, git_tree_entry_id(ea));
+            if (error)
+                break;
+        }
+        if (eb && git_tree_entry_type(eb) == GIT_OBJECT_TREE) {
+            error = git_tree_lookup(&nb, repository, git_tree_entry_id(eb));
+            if (error) {
+                git_tree_free(na);
+                break;
+            }
+        }
+
+        if (ta != a)
+            git_tree_free(ta);
+        if (tb != b)
+            git_tree_free(tb);
+        ta = na;
+        tb = nb;
+        if (!ta && !tb)
+            break;
+
+        path += len + 1;
     }
 
-    return n;
+    if (ta != a)
+        git_tree_free(ta);
+    if (tb != b)
+        git_tree_free(tb);
+    free(name);
+
+    return error;
 }
 
 /* Helper to find how many files in a commit changed from its nth
- * parent. */
+ * parent. If 'path' is not NULL, it's a literal path that is
+ * resolved in both trees instead of diffing the trees with the
+ * pathspec in 'opts'. */
 static int
 git2r_match_with_parent(
     int *out,
     git_commit *commit,
     unsigned int i,
-    git_diff_options *opts)
+    git_diff_options *opts,
+    const char *path)
 {
     int error;
     git_commit *parent = NULL;
@@ -72,6 +225,12 @@ git2r_match_with_parent(
         goto cleanup;
     if ((error = git_commit_tree(&b, commit)) < 0)
         goto cleanup;
+
+    if (path) {
+        error = git2r_match_tree_path(out, a, b, path);
+        goto cleanup;
+    }
+
     if ((error = git_diff_tree_to_tree(&diff, git_commit_owner(commit), a, b, opts)) < 0)
         goto cleanup;
 
@@ -111,11 +270,11 @@ git2r_revwalk_list(
 {
     int error = GIT_OK, nprotect = 0;
     SEXP result = R_NilValue;
-    int i, n;
     unsigned int sort_mode = GIT_SORT_NONE;
     git_revwalk *walker = NULL;
     git_repository *repository = NULL;
     git_oid oid;
+    git2r_oid_array oids = GIT2R_OID_ARRAY_INIT;
 
     if (git2r_arg_check_sha(sha))
         git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
@@ -156,48 +315,21 @@ git2r_revwalk_list(
         goto cleanup;
     git_revwalk_sorting(walker, sort_mode);
 
-    /* Count number of revisions before creating the list */
-    n = git2r_revwalk_count(walker, INTEGER(max_n)[0]);
-
-    /* Create list to store result */
-    PROTECT(result = Rf_allocVector(VECSXP, n));
-    nprotect++;
-
-    git_revwalk_reset(walker);
-    error = git_revwalk_push(walker, &oid);
+    /* Walk the revisions once, then create the list */
+    error = git2r_revwalk_collect(&oids, walker, INTEGER(max_n)[0]);
     if (error)
         goto cleanup;
-    git_revwalk_sorting(walker, sort_mode);
-
-    for (i = 0; i < n; i++) {
-        git_commit *commit;
-        SEXP item;
-        git_oid oid;
 
-        error = git_revwalk_next(&oid, walker);
-        if (error) {
-            if (GIT_ITEROVER == error)
-                error = GIT_OK;
-            goto cleanup;
-        }
-
-        error = git_commit_lookup(&commit, repository, &oid);
-        if (error)
-            goto cleanup;
-
-        SET_VECTOR_ELT(
-            result,
-            i,
-            item = Rf_mkNamed(VECSXP, git2r_S3_items__git_commit));
-        Rf_setAttrib(item, R_ClassSymbol,
-                     Rf_mkString(git2r_S3_class__git_commit));
-        git2r_commit_init(commit, repo, item);
-        git_commit_free(commit);
-    }
+    error = git2r_revwalk_commit_list(&result, &oids, repository, repo);
+    if (error)
+        goto cleanup;
+    PROTECT(result);
+    nprotect++;
 
 cleanup:
+    git2r_oid_array_free(&oids);
     git_revwalk_free(walker);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -233,7 +365,6 @@ git2r_revwalk_list2 (
     SEXP max_n,
     SEXP path)
 {
-    int i = 0;
     int error = GIT_OK;
     int nprotect = 0;
     SEXP result = R_NilValue;
@@ -244,6 +375,9 @@ git2r_revwalk_list2 (
     git_oid oid;
     git_diff_options diffopts = GIT_DIFF_OPTIONS_INIT;
     git_pathspec *ps = NULL;
+    git2r_oid_array oids = GIT2R_OID_ARRAY_INIT;
+    git2r_bloom_index *bloom = NULL;
+    const char *literal = NULL;
 
     if (git2r_arg_check_sha(sha))
         git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
@@ -295,45 +429,54 @@ git2r_revwalk_list2 (
     if (error)
         goto cleanup;
     git_revwalk_sorting(walker, sort_mode);
-    error = git_revwalk_push_head(walker);
-    if (error)
-        goto cleanup;
 
-    n = Rf_asInteger(max_n);
-    if (n < 0) {
-        /* Count number of revisions before creating the list. */
-        n = git2r_revwalk_count(walker, n);
+    /* A single literal path is resolved in the trees instead of
+     * diffing the trees. Use the changed-path index, if the
+     * repository has one, to skip commits that didn't change it. */
+    if (diffopts.pathspec.count == 1 &&
+        git2r_bloom_path_is_literal(diffopts.pathspec.strings[0])) {
+        literal = diffopts.pathspec.strings[0];
+        error = git2r_bloom_index_open(&bloom, repository, 0);
+        if (error)
+            goto cleanup;
     }
 
-    /* Restart the revwalker. */
-    git_revwalk_reset(walker);
-    git_revwalk_sorting(walker, sort_mode);
-    error = git_revwalk_push(walker, &oid);
-    if (error)
-        goto cleanup;
-
-    /* Create the list to store the result. */
-    PROTECT(result = Rf_allocVector(VECSXP, n));
-    nprotect++;
-
-    while (i < n) {
+    /* Walk the revisions once and collect the touching commits
+     * before creating the list. */
+    n = Rf_asInteger(max_n);
+    while (n < 0 || oids.n < (size_t)n) {
         git_commit *commit;
-        SEXP item;
         git_oid oid;
-	unsigned int parents, unmatched;
+        unsigned int parents, unmatched;
         int match;
 
         error = git_revwalk_next(&oid, walker);
         if (error) {
             if (GIT_ITEROVER == error)
                 error = GIT_OK;
-            goto cleanup;
+            break;
         }
 
         error = git_commit_lookup(&commit, repository, &oid);
         if (error)
             goto cleanup;
 
+        /* A commit that didn't change the path compared to the first
+         * parent is not a touching commit. */
+        if (bloom) {
+            int maybe;
+
+            error = git2r_bloom_index_maybe(&maybe, bloom, commit, literal);
+            if (error) {
+                git_commit_free(commit);
+                goto cleanup;
+            }
+            if (!maybe) {
+                git_commit_free(commit);
+                continue;
+            }
+        }
+
         /* Check whether it is a "touching" commit---that is, a commit
 	   that has modified the selected path. */
         parents = git_commit_parentcount(commit);
@@ -344,8 +487,14 @@ git2r_revwalk_list2 (
                 git_commit_free(commit);
                 goto cleanup;
             }
-            error = git_pathspec_match_tree(
-                NULL, tree, GIT_PATHSPEC_NO_MATCH_ERROR, ps);
+            if (literal) {
+                git_tree_entry *entry = NULL;
+                error = git_tree_entry_bypath(&entry, tree, literal);
+                git_tree_entry_free(entry);
+            } else {
+                error = git_pathspec_match_tree(
+                    NULL, tree, GIT_PATHSPEC_NO_MATCH_ERROR, ps);
+            }
 	    git_tree_free(tree);
 	    if (error == GIT_ENOTFOUND) {
                 error = 0;
@@ -355,7 +504,7 @@ git2r_revwalk_list2 (
                 goto cleanup;
             }
 	} else if (parents == 1) {
-            if ((error = git2r_match_with_parent(&match, commit, 0, &diffopts)) < 0) {
+            if ((error = git2r_match_with_parent(&match, commit, 0, &diffopts, literal)) < 0) {
                 git_commit_free(commit);
                 goto cleanup;
             }
@@ -364,7 +513,7 @@ git2r_revwalk_list2 (
             unsigned int j;
 
             for (j = 0; j < parents; j++) {
-                if ((error = git2r_match_with_parent(&match, commit, j, &diffopts)) < 0) {
+                if ((error = git2r_match_with_parent(&match, commit, j, &diffopts, literal)) < 0) {
                     git_commit_free(commit);
                     goto cleanup;
                 }
@@ -373,26 +522,35 @@ git2r_revwalk_list2 (
             }
 	}
 
-        if (unmatched > 0) {
-            git_commit_free(commit);
+        git_commit_free(commit);
+        if (unmatched > 0)
             continue;
-        }
 
-        SET_VECTOR_ELT(
-            result,
-            i,
-            item = Rf_mkNamed(VECSXP, git2r_S3_items__git_commit));
-        Rf_setAttrib(item, R_ClassSymbol,
-                     Rf_mkString(git2r_S3_class__git_commit));
-        git2r_commit_init(commit, repo, item);
-        git_commit_free(commit);
-        i++;
+        error = git2r_oid_array_push(&oids, &oid);
+        if (error)
+            goto cleanup;
     }
+    if (error)
+        goto cleanup;
+
+    /* Create the list to store the result. */
+    error = git2r_revwalk_commit_list(&result, &oids, repository, repo);
+    if (error)
+        goto cleanup;
+    PROTECT(result);
+    nprotect++;
 
 cleanup:
+    /* Keep the filters computed during the walk. A failure to write
+     * the index only means that they are computed again. */
+    if (bloom && !error)
+        git2r_bloom_index_write(bloom);
+    git2r_bloom_index_free(bloom);
     free(diffopts.pathspec.strings);
+    git_pathspec_free(ps);
+    git2r_oid_array_free(&oids);
     git_revwalk_free(walker);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -431,6 +589,7 @@ git2r_revwalk_contributions(
     unsigned int sort_mode = GIT_SORT_NONE;
     git_revwalk *walker = NULL;
     git_repository *repository = NULL;
+    git2r_oid_array oids = GIT2R_OID_ARRAY_INIT;
 
     if (git2r_arg_check_logical(topological))
         git2r_error(__func__, NULL, "'topological'", git2r_err_logical_arg);
@@ -462,10 +621,12 @@ git2r_revwalk_contributions(
         goto cleanup;
     git_revwalk_sorting(walker, sort_mode);
 
-    /* Count number of revisions before creating the list */
-    n = git2r_revwalk_count(walker, -1);
+    /* Walk the revisions once, then create vectors to store result */
+    error = git2r_revwalk_collect(&oids, walker, -1);
+    if (error)
+        goto cleanup;
+    n = oids.n;
 
-    /* Create vectors to store result */
     PROTECT(result = Rf_allocVector(VECSXP, 3));
     nprotect++;
     Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 3));
@@ -476,25 +637,11 @@ git2r_revwalk_contributions(
     SET_VECTOR_ELT(result, 2, email = Rf_allocVector(STRSXP, n));
     SET_STRING_ELT(names, 2, Rf_mkChar("email"));
 
-    git_revwalk_reset(walker);
-    error = git_revwalk_push_head(walker);
-    if (error)
-        goto cleanup;
-    git_revwalk_sorting(walker, sort_mode);
-
     for (i = 0; i < n; i++) {
         git_commit *commit;
         const git_signature *c_author;
-        git_oid oid;
-
-        error = git_revwalk_next(&oid, walker);
-        if (error) {
-            if (GIT_ITEROVER == error)
-                error = GIT_OK;
-            goto cleanup;
-        }
 
-        error = git_commit_lookup(&commit, repository, &oid);
+        error = git_commit_lookup(&commit, repository, &oids.oids[i]);
         if (error)
             goto cleanup;
 
@@ -503,13 +650,190 @@ git2r_revwalk_contributions(
             (double)(c_author->when.time) +
             60.0 * (double)(c_author->when.offset);
         SET_STRING_ELT(author, i, Rf_mkChar(c_author->name));
-        SET_STRING_ELT(author, i, Rf_mkChar(c_author->email));
+        SET_STRING_ELT(email, i, Rf_mkChar(c_author->email));
+        git_commit_free(commit);
+    }
+
+cleanup:
+    git2r_oid_array_free(&oids);
+    git_revwalk_free(walker);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * List revisions as columns of a data.frame.
+ *
+ * @param repo S3 class git_repository
+ * @param sha id of the commit to start from, or R_NilValue to start
+ * from HEAD.
+ * @param topological Sort the commits by topological order; Can be
+ * combined with time.
+ * @param time Sort the commits by commit time; can be combined with
+ * topological.
+ * @param reverse Sort the commits in reverse order
+ * @param max_n n The upper limit of the number of commits to
+ * output. Use max_n < 0 for unlimited number of commits.
+ * @param oid_vector If TRUE, the columns sha and parent are
+ * git_oid_vector's instead of hexadecimal strings.
+ * @return list with the columns sha, summary, message, author,
+ * email, when, author_offset, committer, committer_email,
+ * committer_when, committer_offset, parents and parent.
+ */
+SEXP attribute_hidden
+git2r_revwalk_table(
+    SEXP repo,
+    SEXP sha,
+    SEXP topological,
+    SEXP time,
+    SEXP reverse,
+    SEXP max_n,
+    SEXP oid_vector)
+{
+    const char *names[] = {"sha", "summary", "message", "author", "email",
+                           "when", "author_offset", "committer",
+                           "committer_email", "committer_when",
+                           "committer_offset", "parents", "parent", ""};
+    int error = GIT_OK, nprotect = 0;
+    SEXP result = R_NilValue;
+    size_t i, n = 0;
+    unsigned int sort_mode = GIT_SORT_NONE;
+    git_revwalk *walker = NULL;
+    git_repository *repository = NULL;
+    git_oid oid;
+    git2r_oid_array oids = GIT2R_OID_ARRAY_INIT;
+
+    if (!Rf_isNull(sha) && git2r_arg_check_sha(sha))
+        git2r_error(__func__, NULL, "'sha'", git2r_err_sha_arg);
+    if (git2r_arg_check_logical(topological))
+        git2r_error(__func__, NULL, "'topological'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(time))
+        git2r_error(__func__, NULL, "'time'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(reverse))
+        git2r_error(__func__, NULL, "'reverse'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer(max_n))
+        git2r_error(__func__, NULL, "'max_n'", git2r_err_integer_arg);
+    if (git2r_arg_check_logical(oid_vector))
+        git2r_error(__func__, NULL, "'oid_vector'", git2r_err_logical_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    if (!git_repository_is_empty(repository)) {
+        if (LOGICAL(topological)[0])
+            sort_mode |= GIT_SORT_TOPOLOGICAL;
+        if (LOGICAL(time)[0])
+            sort_mode |= GIT_SORT_TIME;
+        if (LOGICAL(reverse)[0])
+            sort_mode |= GIT_SORT_REVERSE;
+
+        error = git_revwalk_new(&walker, repository);
+        if (error)
+            goto cleanup;
+
+        if (Rf_isNull(sha)) {
+            error = git_revwalk_push_head(walker);
+        } else {
+            git2r_oid_from_sha_sexp(sha, &oid);
+            error = git_revwalk_push(walker, &oid);
+        }
+        if (error)
+            goto cleanup;
+        git_revwalk_sorting(walker, sort_mode);
+
+        error = git2r_revwalk_collect(&oids, walker, INTEGER(max_n)[0]);
+        if (error)
+            goto cleanup;
+        n = oids.n;
+    }
+
+    /* Create the columns with the exact number of commits */
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    nprotect++;
+    if (LOGICAL(oid_vector)[0]) {
+        SET_VECTOR_ELT(result, 0, git2r_oid_vector_alloc(n));
+        SET_VECTOR_ELT(result, 12, git2r_oid_vector_alloc(n));
+    } else {
+        SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n));
+        SET_VECTOR_ELT(result, 12, Rf_allocVector(STRSXP, n));
+    }
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 4, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 5, Rf_allocVector(REALSXP, n));
+    SET_VECTOR_ELT(result, 6, Rf_allocVector(INTSXP, n));
+    SET_VECTOR_ELT(result, 7, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 8, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 9, Rf_allocVector(REALSXP, n));
+    SET_VECTOR_ELT(result, 10, Rf_allocVector(INTSXP, n));
+    SET_VECTOR_ELT(result, 11, Rf_allocVector(INTSXP, n));
+
+    for (i = 0; i < n; i++) {
+        char hex[GIT_OID_HEXSZ + 1];
+        const char *str;
+        const git_signature *signature;
+        git_commit *commit;
+        unsigned int parents;
+
+        error = git_commit_lookup(&commit, repository, &oids.oids[i]);
+        if (error)
+            goto cleanup;
+
+        if (LOGICAL(oid_vector)[0]) {
+            git2r_oid_vector_set(VECTOR_ELT(result, 0), i, &oids.oids[i]);
+        } else {
+            git_oid_tostr(hex, sizeof(hex), &oids.oids[i]);
+            SET_STRING_ELT(VECTOR_ELT(result, 0), i, Rf_mkChar(hex));
+        }
+
+        str = git_commit_summary(commit);
+        SET_STRING_ELT(VECTOR_ELT(result, 1), i,
+                       str ? Rf_mkChar(str) : NA_STRING);
+        str = git_commit_message(commit);
+        SET_STRING_ELT(VECTOR_ELT(result, 2), i,
+                       str ? Rf_mkChar(str) : NA_STRING);
+
+        signature = git_commit_author(commit);
+        SET_STRING_ELT(VECTOR_ELT(result, 3), i, Rf_mkChar(signature->name));
+        SET_STRING_ELT(VECTOR_ELT(result, 4), i, Rf_mkChar(signature->email));
+        REAL(VECTOR_ELT(result, 5))[i] = (double)signature->when.time;
+        INTEGER(VECTOR_ELT(result, 6))[i] = signature->when.offset;
+
+        signature = git_commit_committer(commit);
+        SET_STRING_ELT(VECTOR_ELT(result, 7), i, Rf_mkChar(signature->name));
+        SET_STRING_ELT(VECTOR_ELT(result, 8), i, Rf_mkChar(signature->email));
+        REAL(VECTOR_ELT(result, 9))[i] = (double)signature->when.time;
+        INTEGER(VECTOR_ELT(result, 10))[i] = signature->when.offset;
+
+        parents = git_commit_parentcount(commit);
+        INTEGER(VECTOR_ELT(result, 11))[i] = (int)parents;
+        if (LOGICAL(oid_vector)[0]) {
+            /* The zero oid of a root commit is formatted as NA. */
+            git2r_oid_vector_set(VECTOR_ELT(result, 12), i,
+                                 parents ? git_commit_parent_id(commit, 0) : NULL);
+        } else if (parents) {
+            git_oid_tostr(hex, sizeof(hex), git_commit_parent_id(commit, 0));
+            SET_STRING_ELT(VECTOR_ELT(result, 12), i, Rf_mkChar(hex));
+        } else {
+            SET_STRING_ELT(VECTOR_ELT(result, 12), i, NA_STRING);
+        }
+
         git_commit_free(commit);
     }
 
 cleanup:
+    git2r_oid_array_free(&oids);
     git_revwalk_free(walker);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -0,0 +1,173 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2026 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/** @file git2r_sha1.c
+ *  @brief Incremental SHA-1
+ *
+ *  libgit2 only exposes one-shot hashing of objects, with
+ *  git_odb_hash(), so this small SHA-1 (FIPS 180-4) is used to hash
+ *  objects that are fed in chunks.
+ */
+
+#include <string.h>
+
+#include "git2r_sha1.h"
+
+#define GIT2R_SHA1_ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/**
+ * Process one 64-byte block
+ *
+ * @param h The hash state
+ * @param p The block
+ * @return void
+ */
+static void
+git2r_sha1_block(
+    uint32_t h[5],
+    const unsigned char *p)
+{
+    uint32_t w[80], a, b, c, d, e, f, k, t;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+            ((uint32_t)p[4 * i + 2] << 8) | (uint32_t)p[4 * i + 3];
+    }
+    for (i = 16; i < 80; i++)
+        w[i] = GIT2R_SHA1_ROL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    a = h[0];
+    b = h[1];
+    c = h[2];
+    d = h[3];
+    e = h[4];
+
+    for (i = 0; i < 80; i++) {
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5a827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ed9eba1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8f1bbcdc;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xca62c1d6;
+        }
+
+        t = GIT2R_SHA1_ROL(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = GIT2R_SHA1_ROL(b, 30);
+        b = a;
+        a = t;
+    }
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
+
+/**
+ * Initialize a SHA-1 context
+ *
+ * @param ctx The context to initialize
+ * @return void
+ */
+void
+git2r_sha1_init(
+    git2r_sha1_ctx *ctx)
+{
+    ctx->h[0] = 0x67452301;
+    ctx->h[1] = 0xefcdab89;
+    ctx->h[2] = 0x98badcfe;
+    ctx->h[3] = 0x10325476;
+    ctx->h[4] = 0xc3d2e1f0;
+    ctx->len = 0;
+}
+
+/**
+ * Add data to a SHA-1 context
+ *
+ * @param ctx The context
+ * @param data The data to add
+ * @param len The number of bytes in data
+ * @return void
+ */
+void
+git2r_sha1_update(
+    git2r_sha1_ctx *ctx,
+    const void *data,
+    size_t len)
+{
+    const unsigned char *p = (const unsigned char*)data;
+    size_t used = (size_t)(ctx->len % 64);
+
+    ctx->len += len;
+
+    if (used) {
+        size_t n = 64 - used;
+        if (len < n) {
+            memcpy(ctx->buf + used, p, len);
+            return;
+        }
+        memcpy(ctx->buf + used, p, n);
+        git2r_sha1_block(ctx->h, ctx->buf);
+        p += n;
+        len -= n;
+    }
+
+    for (; len >= 64; p += 64, len -= 64)
+        git2r_sha1_block(ctx->h, p);
+
+    if (len)
+        memcpy(ctx->buf, p, len);
+}
+
+/**
+ * Finish a SHA-1 context
+ *
+ * @param out The 20 bytes of the hash
+ * @param ctx The context
+ * @return void
+ */
+void
+git2r_sha1_final(
+    unsigned char out[20],
+    git2r_sha1_ctx *ctx)
+{
+    static const unsigned char pad[64] = {0x80};
+    unsigned char bits[8];
+    uint64_t nbits = ctx->len * 8;
+    size_t used = (size_t)(ctx->len % 64);
+    int i;
+
+    for (i = 0; i < 8; i++)
+        bits[i] = (unsigned char)(nbits >> (56 - 8 * i));
+
+    git2r_sha1_update(ctx, pad, used < 56 ? 56 - used : 120 - used);
+    git2r_sha1_update(ctx, bits, 8);
+
+    for (i = 0; i < 20; i++)
+        out[i] = (unsigned char)(ctx->h[i / 4] >> (24 - 8 * (i % 4)));
+}
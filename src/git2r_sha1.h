@@ -0,0 +1,38 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2026 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDE_git2r_sha1_h
+#define INCLUDE_git2r_sha1_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Context to compute a SHA-1 incrementally.
+ */
+typedef struct {
+    uint32_t h[5];
+    uint64_t len;
+    unsigned char buf[64];
+} git2r_sha1_ctx;
+
+void git2r_sha1_init(git2r_sha1_ctx *ctx);
+void git2r_sha1_update(git2r_sha1_ctx *ctx, const void *data, size_t len);
+void git2r_sha1_final(unsigned char out[20], git2r_sha1_ctx *ctx);
+
+#endif
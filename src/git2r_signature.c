@@ -52,7 +52,7 @@ git2r_signature_default(
     git2r_signature_init(signature, result);
 
 cleanup:
-    git_repository_free(repository);
+    git2r_repository_close(repository);
     git_signature_free(signature);
 
     if (nprotect)
@@ -17,6 +17,12 @@
  */
 
 #include <R_ext/Visibility.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
 #include "git2r_arg.h"
 #include "git2r_error.h"
 #include "git2r_repository.h"
@@ -351,6 +357,534 @@ git2r_status_list_untracked(
     }
 }
 
+/**
+ * The modification time of a directory or a file when the snapshot
+ * of the untracked files was taken. A missing file has the time -1.
+ */
+typedef struct {
+    char *path;
+    double mtime;
+} git2r_status_stamp;
+
+/**
+ * Snapshot of the untracked and ignored files in a working
+ * directory. Adding or removing a file changes the modification time
+ * of its directory, so the lists are valid while the modification
+ * times of the directories, of the exclude files and of the index
+ * are unchanged. The first stamp is the index.
+ */
+typedef struct {
+    char *workdir;
+    int flags;
+    git2r_status_stamp *stamps;
+    size_t n_stamps;
+    size_t size_stamps;
+    char **untracked;
+    size_t n_untracked;
+    char **ignored;
+    size_t n_ignored;
+} git2r_status_snapshot;
+
+/**
+ * Session-scoped cache with a snapshot of the untracked and ignored
+ * files per working directory.
+ */
+static struct {
+    git2r_status_snapshot *entries;
+    size_t n;
+} git2r_status_cache = {NULL, 0};
+
+#define GIT2R_STATUS_CACHE_UNTRACKED     1
+#define GIT2R_STATUS_CACHE_ALL_UNTRACKED 2
+#define GIT2R_STATUS_CACHE_IGNORED       4
+
+static char*
+git2r_status_strdup(
+    const char *a,
+    const char *b)
+{
+    size_t len_a = strlen(a), len_b = b ? strlen(b) : 0;
+    char *str = malloc(len_a + len_b + 1);
+
+    if (str) {
+        memcpy(str, a, len_a);
+        if (len_b)
+            memcpy(str + len_a, b, len_b);
+        str[len_a + len_b] = '\0';
+    }
+
+    return str;
+}
+
+/**
+ * Get the modification time of a path, with the resolution of the
+ * file system where available.
+ *
+ * @param path The path.
+ * @return The time in seconds, or -1 if the path does not exist.
+ */
+static double
+git2r_status_mtime(
+    const char *path)
+{
+    struct stat st;
+
+    if (stat(path, &st))
+        return -1;
+
+#if defined(__APPLE__)
+    return (double)st.st_mtimespec.tv_sec + st.st_mtimespec.tv_nsec * 1e-9;
+#elif defined(_WIN32)
+    return (double)st.st_mtime;
+#else
+    return (double)st.st_mtim.tv_sec + st.st_mtim.tv_nsec * 1e-9;
+#endif
+}
+
+static void
+git2r_status_snapshot_free(
+    git2r_status_snapshot *snapshot)
+{
+    size_t i;
+
+    for (i = 0; i < snapshot->n_stamps; i++)
+        free(snapshot->stamps[i].path);
+    free(snapshot->stamps);
+    for (i = 0; i < snapshot->n_untracked; i++)
+        free(snapshot->untracked[i]);
+    free(snapshot->untracked);
+    for (i = 0; i < snapshot->n_ignored; i++)
+        free(snapshot->ignored[i]);
+    free(snapshot->ignored);
+    free(snapshot->workdir);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+/**
+ * Add a stamp with the modification time of a path to the snapshot.
+ *
+ * @param snapshot The snapshot.
+ * @param path The path. The snapshot takes the ownership.
+ * @param start The time when the snapshot was started. A path that
+ * was modified after the start is racy, since a later modification
+ * in the same tick of the clock cannot be detected. Use 0 to skip
+ * the check.
+ * @return 0 if OK, 1 if the path is racy, else -1.
+ */
+static int
+git2r_status_snapshot_stamp(
+    git2r_status_snapshot *snapshot,
+    char *path,
+    time_t start)
+{
+    double mtime;
+
+    if (!path)
+        return -1;
+
+    if (snapshot->n_stamps == snapshot->size_stamps) {
+        size_t size = snapshot->size_stamps ? 2 * snapshot->size_stamps : 64;
+        git2r_status_stamp *stamps =
+            realloc(snapshot->stamps, size * sizeof(git2r_status_stamp));
+        if (!stamps) {
+            free(path);
+            return -1;
+        }
+        snapshot->stamps = stamps;
+        snapshot->size_stamps = size;
+    }
+
+    mtime = git2r_status_mtime(path);
+    snapshot->stamps[snapshot->n_stamps].path = path;
+    snapshot->stamps[snapshot->n_stamps].mtime = mtime;
+    snapshot->n_stamps++;
+
+    return (start && mtime >= (double)start) ? 1 : 0;
+}
+
+/**
+ * Stamp a directory, its '.gitignore' and recursively the
+ * sub-directories that are not ignored.
+ *
+ * @param snapshot The snapshot.
+ * @param repository The repository.
+ * @param dir The path relative to the working directory, with a
+ * trailing '/', or "" for the working directory.
+ * @param start The time when the snapshot was started.
+ * @return 0 if OK, else non-zero.
+ */
+static int
+git2r_status_snapshot_walk(
+    git2r_status_snapshot *snapshot,
+    git_repository *repository,
+    const char *dir,
+    time_t start)
+{
+    int error;
+    char *path;
+    DIR *d;
+    struct dirent *entry;
+
+    path = git2r_status_strdup(snapshot->workdir, dir);
+    if (!path)
+        return -1;
+    error = git2r_status_snapshot_stamp(snapshot, path, start);
+    if (error)
+        return error;
+
+    d = opendir(path);
+    if (!d)
+        return -1;
+
+    while (!error && (entry = readdir(d)) != NULL) {
+        const char *name = entry->d_name;
+        char *sub, *full;
+        struct stat st;
+        int ignored = 0;
+
+        if (!strcmp(name, ".") || !strcmp(name, "..") || !strcmp(name, ".git"))
+            continue;
+
+        full = git2r_status_strdup(path, name);
+        if (!full) {
+            error = -1;
+            break;
+        }
+
+        if (!strcmp(name, ".gitignore")) {
+            error = git2r_status_snapshot_stamp(snapshot, full, start);
+            continue;
+        }
+
+#ifdef _WIN32
+        error = stat(full, &st);
+#else
+        error = lstat(full, &st);
+#endif
+        free(full);
+        if (error || !S_ISDIR(st.st_mode)) {
+            error = 0;
+            continue;
+        }
+
+        /* The content of an ignored directory cannot change the
+         * untracked files, and an ignored directory is listed
+         * without its content. */
+        sub = malloc(strlen(dir) + strlen(name) + 2);
+        if (!sub) {
+            error = -1;
+            break;
+        }
+        strcpy(sub, dir);
+        strcat(sub, name);
+        strcat(sub, "/");
+        error = git_ignore_path_is_ignored(&ignored, repository, sub);
+        if (!error && !ignored)
+            error = git2r_status_snapshot_walk(snapshot, repository, sub, start);
+        free(sub);
+    }
+
+    closedir(d);
+
+    return error;
+}
+
+/**
+ * Copy the paths of the entries with a status to the snapshot.
+ *
+ * @param out The list of paths.
+ * @param n The number of paths.
+ * @param status_list The status.
+ * @param status The status of the entries to copy.
+ * @return 0 if OK, else -1.
+ */
+static int
+git2r_status_snapshot_paths(
+    char ***out,
+    size_t *n,
+    git_status_list *status_list,
+    git_status_t status)
+{
+    size_t i, count = git_status_list_entrycount(status_list);
+
+    *out = malloc((count ? count : 1) * sizeof(char*));
+    if (!*out)
+        return -1;
+
+    for (i = 0; i < count; i++) {
+        const git_status_entry *s = git_status_byindex(status_list, i);
+
+        if (s->status == status) {
+            char *path = git2r_status_strdup(s->index_to_workdir->old_file.path, NULL);
+            if (!path)
+                return -1;
+            (*out)[(*n)++] = path;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Find the snapshot of a working directory in the cache.
+ *
+ * @param workdir The working directory.
+ * @return The index of the snapshot, or -1 if not in the cache.
+ */
+static int
+git2r_status_cache_find(
+    const char *workdir)
+{
+    size_t i;
+
+    for (i = 0; i < git2r_status_cache.n; i++) {
+        if (!strcmp(git2r_status_cache.entries[i].workdir, workdir))
+            return (int)i;
+    }
+
+    return -1;
+}
+
+static void
+git2r_status_cache_remove(
+    size_t i)
+{
+    git2r_status_snapshot_free(&git2r_status_cache.entries[i]);
+    git2r_status_cache.n--;
+    if (i < git2r_status_cache.n) {
+        memmove(&git2r_status_cache.entries[i],
+                &git2r_status_cache.entries[i + 1],
+                (git2r_status_cache.n - i) * sizeof(git2r_status_snapshot));
+    }
+}
+
+/**
+ * Get a valid snapshot of a working directory from the cache. An
+ * invalid snapshot is removed from the cache.
+ *
+ * @param workdir The working directory.
+ * @param flags The GIT2R_STATUS_CACHE flags of the status.
+ * @return The snapshot, or NULL.
+ */
+static git2r_status_snapshot*
+git2r_status_cache_get(
+    const char *workdir,
+    int flags)
+{
+    size_t j;
+    int i = git2r_status_cache_find(workdir);
+    git2r_status_snapshot *snapshot;
+
+    if (i < 0)
+        return NULL;
+
+    snapshot = &git2r_status_cache.entries[i];
+    if (snapshot->flags != flags)
+        goto invalid;
+    for (j = 0; j < snapshot->n_stamps; j++) {
+        if (git2r_status_mtime(snapshot->stamps[j].path) != snapshot->stamps[j].mtime)
+            goto invalid;
+    }
+
+    return snapshot;
+
+invalid:
+    git2r_status_cache_remove(i);
+    return NULL;
+}
+
+/**
+ * Take a snapshot of the untracked and ignored files in the status
+ * and add it to the cache. The snapshot is not added if it is racy,
+ * or if a path is both deleted in the index and untracked, since
+ * such an entry depends on both lists.
+ *
+ * @param repository The repository.
+ * @param workdir The working directory.
+ * @param flags The GIT2R_STATUS_CACHE flags of the status.
+ * @param status_list The status, including untracked and ignored
+ * files according to the flags.
+ * @param start The time when the status was started.
+ * @return void
+ */
+static void
+git2r_status_cache_add(
+    git_repository *repository,
+    const char *workdir,
+    int flags,
+    git_status_list *status_list,
+    time_t start)
+{
+    int error = 0;
+    size_t i, count = git_status_list_entrycount(status_list);
+    git2r_status_snapshot snapshot;
+
+    for (i = 0; i < count; i++) {
+        const git_status_entry *s = git_status_byindex(status_list, i);
+
+        if (s->status == (GIT_STATUS_INDEX_DELETED | GIT_STATUS_WT_NEW))
+            return;
+    }
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.flags = flags;
+    snapshot.workdir = git2r_status_strdup(workdir, NULL);
+    if (!snapshot.workdir)
+        goto cleanup;
+
+    /* The index is stamped after the status, which may have written
+     * the refreshed stat data to it. */
+    error = git2r_status_snapshot_stamp(
+        &snapshot, git2r_status_strdup(git_repository_path(repository), "index"), 0);
+    if (error < 0)
+        goto cleanup;
+    error = git2r_status_snapshot_stamp(
+        &snapshot, git2r_status_strdup(git_repository_path(repository), "info/exclude"), start);
+    if (!error)
+        error = git2r_status_snapshot_walk(&snapshot, repository, "", start);
+    if (!error)
+        error = git2r_status_snapshot_paths(
+            &snapshot.untracked, &snapshot.n_untracked, status_list, GIT_STATUS_WT_NEW);
+    if (!error)
+        error = git2r_status_snapshot_paths(
+            &snapshot.ignored, &snapshot.n_ignored, status_list, GIT_STATUS_IGNORED);
+    if (error)
+        goto cleanup;
+
+    i = git2r_status_cache.n;
+    if (i % 8 == 0) {
+        git2r_status_snapshot *entries = realloc(
+            git2r_status_cache.entries, (i + 8) * sizeof(git2r_status_snapshot));
+        if (!entries)
+            goto cleanup;
+        git2r_status_cache.entries = entries;
+    }
+    git2r_status_cache.entries[i] = snapshot;
+    git2r_status_cache.n++;
+    return;
+
+cleanup:
+    /* Failing to take a snapshot only means that the next status
+     * scans the working directory again. */
+    git_error_clear();
+    git2r_status_snapshot_free(&snapshot);
+}
+
+/**
+ * Free all snapshots in the cache of untracked files.
+ */
+void attribute_hidden
+git2r_status_cache_free(void)
+{
+    while (git2r_status_cache.n)
+        git2r_status_cache_remove(git2r_status_cache.n - 1);
+    free(git2r_status_cache.entries);
+    git2r_status_cache.entries = NULL;
+}
+
+/**
+ * Remove the snapshot of the untracked files of a repository, or of
+ * all repositories, from the cache.
+ *
+ * @param repo S3 class git_repository, or R_NilValue to clear the
+ * cache.
+ * @return R_NilValue
+ */
+SEXP attribute_hidden
+git2r_status_cache_clear(
+    SEXP repo)
+{
+    int i;
+    const char *workdir;
+    git_repository *repository;
+
+    if (Rf_isNull(repo)) {
+        git2r_status_cache_free();
+        return R_NilValue;
+    }
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    workdir = git_repository_workdir(repository);
+    if (workdir && (i = git2r_status_cache_find(workdir)) >= 0)
+        git2r_status_cache_remove(i);
+
+    git2r_repository_close(repository);
+
+    return R_NilValue;
+}
+
+/**
+ * Add the paths of the untracked or ignored files from a snapshot
+ *
+ * @param list The list to hold the result
+ * @param list_index The index in list where to add the new sub list
+ * @param name The name of each entry in the sub list
+ * @param paths The paths
+ * @param n The number of paths
+ * @return void
+ */
+static void
+git2r_status_list_paths(
+    SEXP list,
+    size_t list_index,
+    const char *name,
+    char **paths,
+    size_t n)
+{
+    size_t i;
+    SEXP sub_list, sub_list_names;
+
+    SET_VECTOR_ELT(list, list_index, sub_list = Rf_allocVector(VECSXP, n));
+    Rf_setAttrib(sub_list, R_NamesSymbol, sub_list_names = Rf_allocVector(STRSXP, n));
+    for (i = 0; i < n; i++) {
+        SET_VECTOR_ELT(sub_list, i, Rf_mkString(paths[i]));
+        SET_STRING_ELT(sub_list_names, i, Rf_mkChar(name));
+    }
+}
+
+/**
+ * Initialize the status options
+ *
+ * @param opts The options to initialize. The caller must free
+ * opts->pathspec.strings.
+ * @param untracked Include untracked files and directories.
+ * @param all_untracked Shows individual files in untracked
+ *        directories if 'untracked' is 'TRUE'.
+ * @param ignored Include ignored files.
+ * @param path A character vector with paths / fnmatch patterns, or
+ * R_NilValue. Only the directories that can match the pathspec are
+ * scanned.
+ * @return 0 if OK, else error code
+ */
+static int
+git2r_status_options_init(
+    git_status_options *opts,
+    SEXP untracked,
+    SEXP all_untracked,
+    SEXP ignored,
+    SEXP path)
+{
+    opts->show  = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    opts->flags = GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+        GIT_STATUS_OPT_SORT_CASE_SENSITIVELY;
+
+    if (LOGICAL(untracked)[0]) {
+        opts->flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED;
+        if (LOGICAL(all_untracked)[0])
+            opts->flags |= GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+    }
+    if (LOGICAL(ignored)[0])
+        opts->flags |= GIT_STATUS_OPT_INCLUDE_IGNORED;
+
+    if (!Rf_isNull(path))
+        return git2r_copy_string_vec(&opts->pathspec, path);
+
+    return 0;
+}
+
 /**
  * Get state of the repository working directory and the staging area.
  *
@@ -361,6 +895,15 @@ git2r_status_list_untracked(
  * @param all_untracked Shows individual files in untracked
  *        directories if 'untracked' is 'TRUE'.
  * @param ignored Include ignored files.
+ * @param path A character vector with paths / fnmatch patterns to
+ * constrain the status, or R_NilValue for the whole working
+ * directory.
+ * @param update_index Write the refreshed stat data of the files
+ * to the index, so that racily clean files are not hashed again by
+ * the next status.
+ * @param untracked_cache Reuse the untracked and ignored files from
+ * the snapshot of the previous status of the working directory in
+ * the session, if no directory has been modified.
  * @return VECXSP with status
  */
 SEXP attribute_hidden
@@ -370,10 +913,16 @@ git2r_status_list(
     SEXP unstaged,
     SEXP untracked,
     SEXP all_untracked,
-    SEXP ignored)
+    SEXP ignored,
+    SEXP path,
+    SEXP update_index,
+    SEXP untracked_cache)
 {
-    int error, nprotect = 0;
+    int error, nprotect = 0, cache_flags = 0;
     size_t i=0, count;
+    time_t start;
+    const char *workdir = NULL;
+    git2r_status_snapshot *snapshot = NULL;
     SEXP list = R_NilValue;
     SEXP list_names = R_NilValue;
     git_repository *repository;
@@ -390,26 +939,59 @@ git2r_status_list(
         git2r_error(__func__, NULL, "'all_untracked'", git2r_err_logical_arg);
     if (git2r_arg_check_logical(ignored))
         git2r_error(__func__, NULL, "'ignored'", git2r_err_logical_arg);
+    if (!Rf_isNull(path) && git2r_arg_check_string_vec(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_logical(update_index))
+        git2r_error(__func__, NULL, "'update_index'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(untracked_cache))
+        git2r_error(__func__, NULL, "'untracked_cache'", git2r_err_logical_arg);
 
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    opts.show  = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
-    opts.flags = GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
-        GIT_STATUS_OPT_SORT_CASE_SENSITIVELY;
+    error = git2r_status_options_init(
+        &opts, untracked, all_untracked, ignored, path);
+    if (error)
+        goto cleanup;
+    if (LOGICAL(update_index)[0])
+        opts.flags |= GIT_STATUS_OPT_UPDATE_INDEX;
 
-    if (LOGICAL(untracked)[0]) {
-        opts.flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED;
-        if (LOGICAL(all_untracked)[0])
-            opts.flags |= GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+    /* The snapshot only holds the untracked and ignored files of the
+     * whole working directory. */
+    if (LOGICAL(untracked_cache)[0] && Rf_isNull(path)) {
+        if (LOGICAL(untracked)[0]) {
+            cache_flags |= GIT2R_STATUS_CACHE_UNTRACKED;
+            if (LOGICAL(all_untracked)[0])
+                cache_flags |= GIT2R_STATUS_CACHE_ALL_UNTRACKED;
+        }
+        if (LOGICAL(ignored)[0])
+            cache_flags |= GIT2R_STATUS_CACHE_IGNORED;
+        workdir = git_repository_workdir(repository);
     }
-    if (LOGICAL(ignored)[0])
-        opts.flags |= GIT_STATUS_OPT_INCLUDE_IGNORED;
+    if (cache_flags && workdir) {
+        snapshot = git2r_status_cache_get(workdir, cache_flags);
+        if (snapshot) {
+            opts.flags &= ~(GIT_STATUS_OPT_INCLUDE_UNTRACKED |
+                            GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS |
+                            GIT_STATUS_OPT_INCLUDE_IGNORED);
+        }
+    }
+
+    start = time(NULL);
     error = git_status_list_new(&status_list, repository, &opts);
     if (error)
         goto cleanup;
 
+    if (snapshot) {
+        /* Our own write of the refreshed stat data does not change
+         * the entries in the index. */
+        if (LOGICAL(update_index)[0])
+            snapshot->stamps[0].mtime = git2r_status_mtime(snapshot->stamps[0].path);
+    } else if (cache_flags && workdir) {
+        git2r_status_cache_add(repository, workdir, cache_flags, status_list, start);
+    }
+
     count = LOGICAL(staged)[0] +
         LOGICAL(unstaged)[0] +
         LOGICAL(untracked)[0] +
@@ -433,19 +1015,30 @@ git2r_status_list(
 
     if (LOGICAL(untracked)[0]) {
         SET_STRING_ELT(list_names, i, Rf_mkChar("untracked"));
-        git2r_status_list_untracked(list, i, status_list);
+        if (snapshot) {
+            git2r_status_list_paths(list, i, "untracked",
+                                    snapshot->untracked, snapshot->n_untracked);
+        } else {
+            git2r_status_list_untracked(list, i, status_list);
+        }
         i++;
     }
 
     if (LOGICAL(ignored)[0]) {
         SET_STRING_ELT(list_names, i, Rf_mkChar("ignored"));
-        git2r_status_list_ignored(list, i, status_list);
+        if (snapshot) {
+            git2r_status_list_paths(list, i, "ignored",
+                                    snapshot->ignored, snapshot->n_ignored);
+        } else {
+            git2r_status_list_ignored(list, i, status_list);
+        }
     }
 
 
 cleanup:
+    free(opts.pathspec.strings);
     git_status_list_free(status_list);
-    git_repository_free(repository);
+    git2r_repository_close(repository);
 
     if (nprotect)
         UNPROTECT(nprotect);
@@ -455,3 +1048,111 @@ cleanup:
 
     return list;
 }
+
+/**
+ * Get the state of the working directory and the staging area as
+ * columns, with one row per changed file.
+ *
+ * The columns 'index' and 'workdir' are the bits of the
+ * git_status_t flags of the changes from HEAD to the index and from
+ * the index to the working directory. The column 'renamed_from' is
+ * the path before a rename, or NA.
+ *
+ * @param repo S3 class git_repository
+ * @param untracked Include untracked files and directories.
+ * @param all_untracked Shows individual files in untracked
+ *        directories if 'untracked' is 'TRUE'.
+ * @param ignored Include ignored files.
+ * @param path A character vector with paths / fnmatch patterns to
+ * constrain the status, or R_NilValue for the whole working
+ * directory.
+ * @return list with the columns path, index, workdir and
+ * renamed_from.
+ */
+SEXP attribute_hidden
+git2r_status_table(
+    SEXP repo,
+    SEXP untracked,
+    SEXP all_untracked,
+    SEXP ignored,
+    SEXP path)
+{
+    const char *names[] = {"path", "index", "workdir", "renamed_from", ""};
+    const unsigned int index_mask =
+        GIT_STATUS_INDEX_NEW | GIT_STATUS_INDEX_MODIFIED |
+        GIT_STATUS_INDEX_DELETED | GIT_STATUS_INDEX_RENAMED |
+        GIT_STATUS_INDEX_TYPECHANGE;
+    int error, nprotect = 0;
+    size_t i, n;
+    SEXP result = R_NilValue;
+    git_repository *repository;
+    git_status_list *status_list = NULL;
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+
+    if (git2r_arg_check_logical(untracked))
+        git2r_error(__func__, NULL, "'untracked'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(all_untracked))
+        git2r_error(__func__, NULL, "'all_untracked'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(ignored))
+        git2r_error(__func__, NULL, "'ignored'", git2r_err_logical_arg);
+    if (!Rf_isNull(path) && git2r_arg_check_string_vec(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    error = git2r_status_options_init(
+        &opts, untracked, all_untracked, ignored, path);
+    if (error)
+        goto cleanup;
+    error = git_status_list_new(&status_list, repository, &opts);
+    if (error)
+        goto cleanup;
+
+    n = git_status_list_entrycount(status_list);
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    nprotect++;
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(INTSXP, n));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(INTSXP, n));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(STRSXP, n));
+
+    for (i = 0; i < n; i++) {
+        const char *new_path = NULL, *old_path = NULL;
+        const git_status_entry *s = git_status_byindex(status_list, i);
+
+        /* The path in the working directory, else in the index. */
+        if (s->index_to_workdir) {
+            new_path = s->index_to_workdir->new_file.path;
+            if (s->status & GIT_STATUS_WT_RENAMED)
+                old_path = s->index_to_workdir->old_file.path;
+        }
+        if (s->head_to_index) {
+            if (!new_path)
+                new_path = s->head_to_index->new_file.path;
+            if (s->status & GIT_STATUS_INDEX_RENAMED)
+                old_path = s->head_to_index->old_file.path;
+        }
+
+        SET_STRING_ELT(VECTOR_ELT(result, 0), i,
+                       new_path ? Rf_mkChar(new_path) : NA_STRING);
+        INTEGER(VECTOR_ELT(result, 1))[i] = (int)(s->status & index_mask);
+        INTEGER(VECTOR_ELT(result, 2))[i] = (int)(s->status & ~index_mask);
+        SET_STRING_ELT(VECTOR_ELT(result, 3), i,
+                       old_path ? Rf_mkChar(old_path) : NA_STRING);
+    }
+
+cleanup:
+    free(opts.pathspec.strings);
+    git_status_list_free(status_list);
+    git2r_repository_close(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (error)
+        git2r_error(__func__, git_error_last(), NULL, NULL);
+
+    return result;
+}
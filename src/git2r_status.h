@@ -28,6 +28,19 @@ SEXP git2r_status_list(
     SEXP unstaged,
     SEXP untracked,
     SEXP all_untracked,
-    SEXP ignored);
+    SEXP ignored,
+    SEXP path,
+    SEXP update_index,
+    SEXP untracked_cache);
+
+SEXP git2r_status_cache_clear(SEXP repo);
+void git2r_status_cache_free(void);
+
+SEXP git2r_status_table(
+    SEXP repo,
+    SEXP untracked,
+    SEXP all_untracked,
+    SEXP ignored,
+    SEXP path);
 
 #endif
@@ -18,9 +18,13 @@
 
 #include <R_ext/Visibility.h>
 #include <git2.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
+#include "git2r_oid.h"
 #include "git2r_repository.h"
 #include "git2r_S3.h"
 #include "git2r_tree.h"
@@ -85,15 +89,121 @@ git2r_tree_init(
 }
 
 /**
- * Data structure to hold information for the tree traversal.
+ * Data structure to hold information for the tree traversal. The
+ * columns in 'list' are filled in one walk, and doubled when they
+ * are full.
  */
 typedef struct {
     size_t n;
+    size_t size;
     SEXP list;
     int recursive;
-    git_repository *repository;
+    int max_depth;
+    int oid_vector;
+    int n_columns;
+    git_odb *odb;
+    git_pathspec *pathspec;
+    git_strarray prefixes;
+    char *buf;
+    size_t buf_size;
 } git2r_tree_walk_cb_data;
 
+/**
+ * Get the literal prefix of a pathspec, which is the part before
+ * the first path component with a wildcard. A path without
+ * wildcards is also a directory prefix, so it gets a trailing '/'.
+ *
+ * @param pattern The pathspec
+ * @return The prefix, which the caller must free, or NULL if out of
+ * memory.
+ */
+static char*
+git2r_tree_pathspec_prefix(
+    const char *pattern)
+{
+    size_t len = strcspn(pattern, "*?[\\");
+    char *prefix;
+
+    if (pattern[len] != '\0') {
+        /* Cut the prefix at the last '/' before the wildcard. */
+        while (len > 0 && pattern[len - 1] != '/')
+            len--;
+    }
+
+    prefix = malloc(len + 2);
+    if (!prefix)
+        return NULL;
+    memcpy(prefix, pattern, len);
+    prefix[len] = '\0';
+    if (pattern[len] == '\0' && len > 0 && pattern[len - 1] != '/')
+        strcat(prefix, "/");
+
+    return prefix;
+}
+
+/**
+ * Check if a subtree can contain an entry that matches the pathspec,
+ * i.e. if the path of the subtree and the literal prefix of any
+ * pattern are equal up to the length of the shortest of them.
+ *
+ * @param p The data of the walk
+ * @param path The path of the subtree, with a trailing '/'
+ * @return 1 if the subtree must be walked, else 0
+ */
+static int
+git2r_tree_walk_descend(
+    const git2r_tree_walk_cb_data *p,
+    const char *path)
+{
+    size_t i, len = strlen(path);
+
+    if (!p->pathspec)
+        return 1;
+
+    for (i = 0; i < p->prefixes.count; i++) {
+        const char *prefix = p->prefixes.strings[i];
+        size_t n = strlen(prefix);
+
+        if (!strncmp(path, prefix, n < len ? n : len))
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Create the full path of a tree entry in the buffer of the walk.
+ *
+ * @param p The data of the walk
+ * @param root The path of the tree of the entry
+ * @param name The name of the entry
+ * @param trailing Append a '/' if not zero
+ * @return The path, or NULL if out of memory
+ */
+static const char*
+git2r_tree_walk_path(
+    git2r_tree_walk_cb_data *p,
+    const char *root,
+    const char *name,
+    int trailing)
+{
+    size_t len = strlen(root) + strlen(name) + 2;
+
+    if (len > p->buf_size) {
+        char *buf = realloc(p->buf, len);
+        if (!buf) {
+            giterr_set_oom();
+            return NULL;
+        }
+        p->buf = buf;
+        p->buf_size = len;
+    }
+
+    snprintf(p->buf, p->buf_size, "%s%s%s", root, name, trailing ? "/" : "");
+
+    return p->buf;
+}
+
 /**
  * Callback for the tree traversal method.
  *
@@ -104,66 +214,105 @@ git2r_tree_walk_cb(
     const git_tree_entry *entry,
     void *payload)
 {
-    int error = 0;
+    int error = 0, i, skip = 0;
+    const char *path;
     git2r_tree_walk_cb_data *p = (git2r_tree_walk_cb_data*)payload;
+    char mode[23]; /* enums are int/32-bit, but this is enough for even a 64-bit int */
+    char sha[GIT_OID_HEXSZ + 1];
+
+    if (p->recursive && git_tree_entry_type(entry) == GIT_OBJECT_TREE) {
+        const char *c;
+        int depth = 0;
+
+        /* Skip the subtrees that cannot contain a match. */
+        path = git2r_tree_walk_path(p, root, git_tree_entry_name(entry), 1);
+        if (!path)
+            return -1;
+        if (!git2r_tree_walk_descend(p, path))
+            return 1;
 
-    if (p->recursive) {
+        for (c = root; *c; c++)
+            depth += (*c == '/');
+        if (p->max_depth < 0 || depth < p->max_depth)
+            return 0;
+
+        /* List the subtree at the maximum depth, without walking
+         * it. */
+        skip = 1;
+    } else if (p->recursive) {
         if (git_tree_entry_type(entry) != GIT_OBJECT_BLOB)
             return 0;
     } else if (*root) {
         return 1;
     }
 
-    if (!Rf_isNull(p->list)) {
-        char mode[23]; /* enums are int/32-bit, but this is enough for even a 64-bit int */
-        git_object *blob = NULL, *obj = NULL;
-        char sha[GIT_OID_HEXSZ + 1];
+    if (p->pathspec) {
+        path = git2r_tree_walk_path(p, root, git_tree_entry_name(entry), 0);
+        if (!path)
+            return -1;
+        if (!git_pathspec_matches_path(p->pathspec, 0, path))
+            return skip;
+    }
 
-        /* mode */
-        error = snprintf(mode, sizeof(mode), "%06o", git_tree_entry_filemode(entry));
-        if (error < 0 || (size_t)error >= sizeof(mode)) {
-            error = -1;
-            goto cleanup;
-        }
-        SET_STRING_ELT(VECTOR_ELT(p->list, 0), p->n,
-                       Rf_mkChar(mode));
+    if (p->n == p->size) {
+        p->size *= 2;
+        for (i = 0; i < p->n_columns; i++) {
+            R_xlen_t len = p->size;
 
-        /* type */
-        SET_STRING_ELT(VECTOR_ELT(p->list, 1), p->n,
-                       Rf_mkChar(git_object_type2string(git_tree_entry_type(entry))));
+            if (i == 2 && p->oid_vector)
+                len *= GIT_OID_RAWSZ;
+            SET_VECTOR_ELT(
+                p->list, i,
+                Rf_xlengthgets(VECTOR_ELT(p->list, i), len));
+        }
+    }
 
-        /* sha */
+    /* mode */
+    error = snprintf(mode, sizeof(mode), "%06o", git_tree_entry_filemode(entry));
+    if (error < 0 || (size_t)error >= sizeof(mode))
+        return -1;
+    error = 0;
+    SET_STRING_ELT(VECTOR_ELT(p->list, 0), p->n,
+                   Rf_mkChar(mode));
+
+    /* type */
+    SET_STRING_ELT(VECTOR_ELT(p->list, 1), p->n,
+                   Rf_mkChar(git_object_type2string(git_tree_entry_type(entry))));
+
+    /* sha */
+    if (p->oid_vector) {
+        git2r_oid_vector_set(VECTOR_ELT(p->list, 2), p->n, git_tree_entry_id(entry));
+    } else {
         git_oid_tostr(sha, sizeof(sha), git_tree_entry_id(entry));
         SET_STRING_ELT(VECTOR_ELT(p->list, 2), p->n, Rf_mkChar(sha));
+    }
 
-        /* path */
-        SET_STRING_ELT(VECTOR_ELT(p->list, 3), p->n, Rf_mkChar(root));
+    /* path */
+    SET_STRING_ELT(VECTOR_ELT(p->list, 3), p->n, Rf_mkChar(root));
 
-        /* name */
-        SET_STRING_ELT(VECTOR_ELT(p->list, 4), p->n,
-                       Rf_mkChar(git_tree_entry_name(entry)));
+    /* name */
+    SET_STRING_ELT(VECTOR_ELT(p->list, 4), p->n,
+                   Rf_mkChar(git_tree_entry_name(entry)));
 
-        /* length */
+    /* length, from the object header to not inflate the blob */
+    if (p->odb) {
         if (git_tree_entry_type(entry) == GIT_OBJECT_BLOB) {
-            error = git_tree_entry_to_object(&obj, p->repository, entry);
-            if (error)
-                goto cleanup;
-            error = git_object_peel(&blob, obj, GIT_OBJECT_BLOB);
+            size_t len;
+            git_object_t type;
+
+            error = git_odb_read_header(
+                &len, &type, p->odb, git_tree_entry_id(entry));
             if (error)
-                goto cleanup;
-            INTEGER(VECTOR_ELT(p->list, 5))[p->n] = (int)git_blob_rawsize((git_blob *)blob);
+                return error;
+            INTEGER(VECTOR_ELT(p->list, 5))[p->n] = (int)len;
         } else {
             INTEGER(VECTOR_ELT(p->list, 5))[p->n] = NA_INTEGER;
         }
-
-    cleanup:
-        git_object_free(obj);
-        git_object_free(blob);
     }
 
     p->n += 1;
 
-    return error;
+    return skip;
 }
 
 /**
@@ -171,25 +320,55 @@ git2r_tree_walk_cb(
  *
  * @param tree S3 class git_tree
  * @param recursive recurse into sub-trees.
+ * @param sizes If TRUE, add the column 'len' with the size of the
+ * blobs, which is read from the object headers.
+ * @param path A character vector of paths / fnmatch patterns to
+ * constrain the entries, or R_NilValue for all entries. Subtrees that
+ * cannot contain a match are not walked.
+ * @param max_depth The maximum depth of the subtrees to walk when
+ * recursive, where 0 is the root tree. A subtree at the maximum depth
+ * is listed as an entry. Use a negative value for no limit.
+ * @param oid_vector If TRUE, the column 'sha' is a git_oid_vector
+ * instead of hexadecimal strings.
  * @return A list with entries
  */
 SEXP attribute_hidden
 git2r_tree_walk(
     SEXP tree,
-    SEXP recursive)
+    SEXP recursive,
+    SEXP sizes,
+    SEXP path,
+    SEXP max_depth,
+    SEXP oid_vector)
 {
-    int error, nprotect = 0;
+    const char *names[] = {"mode", "type", "sha", "path", "name", "len", ""};
+    int error, i, nprotect = 0;
     git_oid oid;
     git_tree *tree_obj = NULL;
     git_repository *repository = NULL;
-    git2r_tree_walk_cb_data cb_data = {0, R_NilValue};
+    size_t j;
+    git_strarray pathspec = {0};
+    git2r_tree_walk_cb_data cb_data;
     SEXP repo = R_NilValue, sha = R_NilValue;
-    SEXP result = R_NilValue, names = R_NilValue;
+    SEXP result = R_NilValue;
 
     if (git2r_arg_check_tree(tree))
         git2r_error(__func__, NULL, "'tree'", git2r_err_tree_arg);
     if (git2r_arg_check_logical(recursive))
         git2r_error(__func__, NULL, "'recursive'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(sizes))
+        git2r_error(__func__, NULL, "'sizes'", git2r_err_logical_arg);
+    if (!Rf_isNull(path) && git2r_arg_check_string_vec(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_integer(max_depth))
+        git2r_error(__func__, NULL, "'max_depth'", git2r_err_integer_arg);
+    if (git2r_arg_check_logical(oid_vector))
+        git2r_error(__func__, NULL, "'oid_vector'", git2r_err_logical_arg);
+
+    memset(&cb_data, 0, sizeof(cb_data));
+    cb_data.list = R_NilValue;
+    cb_data.max_depth = INTEGER(max_depth)[0];
+    cb_data.oid_vector = LOGICAL(oid_vector)[0];
 
     repo = git2r_get_list_element(tree, "repo");
     repository = git2r_repository_open(repo);
@@ -202,37 +381,101 @@ git2r_tree_walk(
     if (error)
         goto cleanup;
 
-    /* Count number of entries before creating the list */
-    cb_data.repository = repository;
+    if (LOGICAL(sizes)[0]) {
+        error = git_repository_odb(&cb_data.odb, repository);
+        if (error)
+            goto cleanup;
+    }
+
+    if (!Rf_isNull(path)) {
+        error = git2r_copy_string_vec(&pathspec, path);
+        if (!error && pathspec.count)
+            error = git_pathspec_new(&cb_data.pathspec, &pathspec);
+        if (error)
+            goto cleanup;
+
+        /* The subtrees are pruned with the literal prefixes of the
+         * patterns. A negative pattern can match anywhere, so then
+         * every subtree is walked. */
+        cb_data.prefixes.strings = calloc(pathspec.count, sizeof(char*));
+        if (pathspec.count && !cb_data.prefixes.strings) {
+            giterr_set_oom();
+            error = GIT_ERROR_NOMEMORY;
+            goto cleanup;
+        }
+        cb_data.prefixes.count = pathspec.count;
+        for (j = 0; j < pathspec.count; j++) {
+            const char *pattern = pathspec.strings[j];
+
+            cb_data.prefixes.strings[j] = git2r_tree_pathspec_prefix(
+                pattern[0] == '!' ? "" : pattern);
+            if (!cb_data.prefixes.strings[j]) {
+                giterr_set_oom();
+                error = GIT_ERROR_NOMEMORY;
+                goto cleanup;
+            }
+        }
+    }
+
     if (LOGICAL(recursive)[0])
         cb_data.recursive = 1;
-    error = git_tree_walk(tree_obj, 0, &git2r_tree_walk_cb, &cb_data);
-    if (error)
-        goto cleanup;
+    cb_data.n_columns = cb_data.odb ? 6 : 5;
+    if (!cb_data.odb)
+        names[5] = "";
+
+    /* Start with the number of entries in the root tree, which is
+     * exact when not recursive. */
+    cb_data.size = git_tree_entrycount(tree_obj);
+    if (cb_data.recursive || cb_data.size == 0)
+        cb_data.size = cb_data.size < 1024 ? 1024 : cb_data.size;
 
-    PROTECT(result = Rf_allocVector(VECSXP, 6));
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
     nprotect++;
-    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 6));
-
-    SET_VECTOR_ELT(result, 0,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  0, Rf_mkChar("mode"));
-    SET_VECTOR_ELT(result, 1,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  1, Rf_mkChar("type"));
-    SET_VECTOR_ELT(result, 2,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  2, Rf_mkChar("sha"));
-    SET_VECTOR_ELT(result, 3,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  3, Rf_mkChar("path"));
-    SET_VECTOR_ELT(result, 4,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  4, Rf_mkChar("name"));
-    SET_VECTOR_ELT(result, 5,   Rf_allocVector(INTSXP,  cb_data.n));
-    SET_STRING_ELT(names,  5, Rf_mkChar("len"));
+    for (i = 0; i < cb_data.n_columns; i++) {
+        if (i == 2 && cb_data.oid_vector) {
+            SET_VECTOR_ELT(
+                result, i,
+                Rf_allocVector(RAWSXP, cb_data.size * GIT_OID_RAWSZ));
+        } else {
+            SET_VECTOR_ELT(
+                result, i,
+                Rf_allocVector(i == 5 ? INTSXP : STRSXP, cb_data.size));
+        }
+    }
 
     cb_data.list = result;
-    cb_data.n = 0;
-    error = git_tree_walk(tree_obj, 0, &git2r_tree_walk_cb, &cb_data);
+    error = git_tree_walk(tree_obj, GIT_TREEWALK_PRE, &git2r_tree_walk_cb, &cb_data);
+    if (error)
+        goto cleanup;
+
+    if (cb_data.n < cb_data.size) {
+        for (i = 0; i < cb_data.n_columns; i++) {
+            R_xlen_t len = cb_data.n;
+
+            if (i == 2 && cb_data.oid_vector)
+                len *= GIT_OID_RAWSZ;
+            SET_VECTOR_ELT(
+                result, i,
+                Rf_xlengthgets(VECTOR_ELT(result, i), len));
+        }
+    }
+
+    /* The raw vector is grown without attributes, so set the class
+     * when the length is final. */
+    if (cb_data.oid_vector) {
+        Rf_setAttrib(VECTOR_ELT(result, 2), R_ClassSymbol,
+                     Rf_mkString(git2r_S3_class__git_oid_vector));
+    }
 
 cleanup:
-    git_repository_free(repository);
+    for (j = 0; cb_data.prefixes.strings && j < cb_data.prefixes.count; j++)
+        free(cb_data.prefixes.strings[j]);
+    free(cb_data.prefixes.strings);
+    free(cb_data.buf);
+    git_pathspec_free(cb_data.pathspec);
+    free(pathspec.strings);
+    git_odb_free(cb_data.odb);
+    git2r_repository_close(repository);
     git_tree_free(tree_obj);
 
     if (nprotect)
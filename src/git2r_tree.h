@@ -25,6 +25,6 @@
 #include <git2.h>
 
 void git2r_tree_init(const git_tree *source, SEXP repo, SEXP dest);
-SEXP git2r_tree_walk(SEXP tree, SEXP recursive);
+SEXP git2r_tree_walk(SEXP tree, SEXP recursive, SEXP sizes, SEXP path, SEXP max_depth, SEXP oid_vector);
 
 #endif